@@ -3,886 +3,7800 @@
 #include <imgui.h>
 #include <memory>
 #include <vector>
+#include <string>
+#include <string_view>
 #include <functional>
+#include <utility>
+#include <type_traits>
+#include <algorithm>
+#include <numeric>
+#include <cstdint>
+#include <cstring>
+#include <climits>
+#include <cmath>
+#include <deque>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <chrono>
+#include <typeinfo>
+#include <unordered_map>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#define EASYDEAR_OWNERSHIP_SHARED 0
+#define EASYDEAR_OWNERSHIP_INTRUSIVE 1
+#define EASYDEAR_OWNERSHIP_UNIQUE 2
+
+// Smart pointer behind the Gui* aliases: std::shared_ptr, a non-atomic intrusive
+// reference count, or std::unique_ptr (containers then take ownership by move).
+#ifndef EASYDEAR_OWNERSHIP
+#define EASYDEAR_OWNERSHIP EASYDEAR_OWNERSHIP_SHARED
+#endif
+
+#if defined(__has_include)
+#if __has_include(<cxxabi.h>)
+#include <cxxabi.h>
+#define EASYDEAR_HAS_CXXABI 1
+#endif
+#endif
+
+#if defined(__GLIBC__) || defined(_WIN32)
+#include <malloc.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define EASYDEAR_HAS_SSE2 1
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define EASYDEAR_HAS_MMAP 1
+#endif
+
+// Define EASYDEAR_METRICS_EXPORTER to get MetricsExporter and the socket headers it needs.
+#if defined(EASYDEAR_METRICS_EXPORTER) && (defined(__unix__) || defined(__APPLE__))
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <poll.h>
+#define EASYDEAR_HAS_SOCKETS 1
+#endif
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#include <coroutine>
+#define EASYDEAR_HAS_COROUTINES 1
+#endif
+#endif
 
 namespace hl
 {
     namespace easygui
     {
-        class Object
+        class ThreadPool
         {
+        private:
+            std::vector<std::thread> m_workers;
+            std::deque<std::function<void()>> m_tasks;
+            std::mutex m_mutex;
+            std::condition_variable m_condition;
+            bool m_stopping = false;
+
+            void worker_loop()
+            {
+                for (;;)
+                {
+                    std::function<void()> task;
+                    {
+                        std::unique_lock<std::mutex> lock(m_mutex);
+                        m_condition.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+                        if (m_stopping && m_tasks.empty())
+                            return;
+                        task = std::move(m_tasks.front());
+                        m_tasks.pop_front();
+                    }
+                    task();
+                }
+            }
+
         public:
-            Object() = default;
-            virtual ~Object() = default;
+            ThreadPool(size_t threads = std::max(1u, std::thread::hardware_concurrency()))
+            {
+                m_workers.reserve(threads);
+                for (size_t i = 0; i < threads; i++)
+                {
+                    m_workers.emplace_back([this] { worker_loop(); });
+                }
+            }
 
-            virtual void update() = 0;
-        };
+            ThreadPool(const ThreadPool&) = delete;
+            ThreadPool& operator=(const ThreadPool&) = delete;
 
-        using GuiObject = std::shared_ptr<Object>;
-        using GuiObjectPtr = Object *;
+            ~ThreadPool()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_stopping = true;
+                }
+                m_condition.notify_all();
+                for (auto& worker : m_workers)
+                {
+                    worker.join();
+                }
+            }
 
-        class Window
-        {
-        private:
-            std::vector<GuiObject> m_objects;
-            std::string m_name;
-            bool m_open = true;
-            ImGuiWindowFlags m_flags = 0;
+            static ThreadPool& instance()
+            {
+                static ThreadPool pool;
+                return pool;
+            }
 
-        public:
-            Window(const std::string& name, bool open = true, ImGuiWindowFlags flags = 0)
-                : m_name(name), m_open(open), m_flags(flags)
+            size_t size() const
             {
+                return m_workers.size();
             }
 
-            ~Window() = default;
+            template <typename F>
+            std::future<void> submit(F&& task)
+            {
+                auto packaged = std::make_shared<std::packaged_task<void()>>(std::forward<F>(task));
+                std::future<void> future = packaged->get_future();
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_tasks.emplace_back([packaged] { (*packaged)(); });
+                }
+                m_condition.notify_one();
+                return future;
+            }
 
-            void update()
+            // The calling thread takes part in the work, so this never deadlocks
+            // when called from a worker or when every worker is busy.
+            void parallel_for(size_t count, const std::function<void(size_t)>& fn)
             {
-                ImGui::Begin(m_name.c_str(), &m_open, m_flags);
-                for (auto& object : m_objects)
+                struct State
+                {
+                    std::atomic<size_t> next{0};
+                    std::atomic<size_t> done{0};
+                    std::mutex mutex;
+                    std::condition_variable finished;
+                };
+
+                if (count == 0)
+                    return;
+                auto state = std::make_shared<State>();
+                const std::function<void(size_t)> *body = &fn;
+                auto run = [state, body, count] {
+                    for (size_t i = state->next++; i < count; i = state->next++)
+                    {
+                        (*body)(i);
+                        if (++state->done == count)
+                        {
+                            std::lock_guard<std::mutex> lock(state->mutex);
+                            state->finished.notify_all();
+                        }
+                    }
+                };
+
+                size_t helpers = std::min(count, m_workers.size() + 1) - 1;
                 {
-                    object->update();
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    for (size_t i = 0; i < helpers; i++)
+                    {
+                        m_tasks.emplace_back(run);
+                    }
                 }
-                ImGui::End();
+                m_condition.notify_all();
+                run();
+
+                std::unique_lock<std::mutex> lock(state->mutex);
+                state->finished.wait(lock, [&] { return state->done == count; });
             }
 
-            Window& add_object(GuiObject&& object)
+            // For widgets with an optional pool: nullptr sorts on the global pool, which is only
+            // started by the first sort that needs it.
+            template <typename It, typename Compare>
+            static void parallel_sort_on(ThreadPool *pool, It begin, It end, Compare comp)
             {
-                m_objects.push_back(std::move(object));
-                return *this;
+                (pool != nullptr ? *pool : instance()).parallel_sort(begin, end, comp);
             }
 
-            Window& add_object(GuiObjectPtr object)
+            template <typename It, typename Compare>
+            void parallel_sort(It begin, It end, Compare comp, size_t min_chunk = 1 << 14)
             {
-                m_objects.push_back(GuiObject(object));
-                return *this;
+                size_t count = end - begin;
+                size_t chunks = std::min(m_workers.size() + 1, count / min_chunk);
+                if (chunks < 2)
+                {
+                    std::sort(begin, end, comp);
+                    return;
+                }
+
+                std::vector<size_t> bounds(chunks + 1);
+                for (size_t i = 0; i <= chunks; i++)
+                {
+                    bounds[i] = count * i / chunks;
+                }
+                parallel_for(chunks, [&](size_t i) {
+                    std::sort(begin + bounds[i], begin + bounds[i + 1], comp);
+                });
+                for (size_t width = 1; width < chunks; width *= 2)
+                {
+                    size_t merges = (chunks + 2 * width - 1) / (2 * width);
+                    parallel_for(merges, [&](size_t i) {
+                        size_t first = i * 2 * width;
+                        size_t middle = std::min(first + width, chunks);
+                        size_t last = std::min(first + 2 * width, chunks);
+                        std::inplace_merge(begin + bounds[first], begin + bounds[middle], begin + bounds[last], comp);
+                    });
+                }
             }
         };
 
-        using GuiWindow = std::shared_ptr<Window>;
-        using GuiWindowPtr = Window *;
+#ifdef EASYDEAR_HAS_COROUTINES
+        class Task;
+#endif
 
-        class MenuItem : public Object
+        class JobHandle
         {
         private:
-            std::string m_name;
-            std::string m_shortcut = "";
-            std::function<void()> m_callback = nullptr;
+            struct State
+            {
+                std::function<bool()> step;
+                int priority = 0;
+                std::atomic<bool> cancelled{false};
+                std::atomic<bool> finished{false};
+                std::exception_ptr exception;
+            };
+
+            std::shared_ptr<State> m_state;
+
+            friend class Scheduler;
 
         public:
-            MenuItem(const std::string& name, const std::string& shortcut, std::function<void()> callback)
-                : m_name(name), m_shortcut(shortcut), m_callback(callback)
-            {
-            }
+            JobHandle() = default;
 
-            virtual void update() override
+            void cancel()
             {
-                if (ImGui::MenuItem(m_name.c_str(), m_shortcut.c_str()))
-                    m_callback();
+                if (m_state)
+                    m_state->cancelled = true;
             }
 
-            bool is_valid() const
+            bool is_finished() const
             {
-                return !m_name.empty() && m_callback != nullptr;
+                return m_state && m_state->finished;
             }
 
-            MenuItem& set_name(const std::string& name)
+            bool is_pending() const
             {
-                m_name = name;
-                return *this;
+                return m_state && !m_state->finished && !m_state->cancelled;
             }
+        };
 
-            MenuItem& set_shortcut(const std::string& shortcut)
+        class Scheduler
+        {
+        private:
+            using JobState = JobHandle::State;
+
+            std::vector<std::shared_ptr<JobState>> m_jobs;
+            std::vector<std::shared_ptr<JobState>> m_worker_jobs;
+            std::vector<std::function<void()>> m_posted;
+            std::vector<std::function<void()>> m_running_posted;
+            std::mutex m_posted_mutex;
+            ThreadPool *m_pool = nullptr;
+            size_t m_max_in_flight = 0;
+            size_t m_in_flight = 0;
+            std::mutex m_flight_mutex;
+            std::condition_variable m_flight_done;
+            std::vector<std::shared_ptr<JobState>> m_failed;
+            std::vector<std::shared_ptr<JobState>> m_dispatched;
+            std::vector<std::shared_ptr<JobState>> m_running;
+            std::atomic<uint64_t> m_frame{0};
+            std::chrono::steady_clock::time_point m_deadline;
+            bool m_yielded = false;
+
+            static Scheduler *& current_slot()
             {
-                m_shortcut = shortcut;
-                return *this;
+                static thread_local Scheduler *scheduler = nullptr;
+                return scheduler;
             }
 
-            MenuItem& set_callback(std::function<void()> callback)
+            static void insert_by_priority(std::vector<std::shared_ptr<JobState>>& jobs, const std::shared_ptr<JobState>& job)
             {
-                m_callback = callback;
-                return *this;
+                auto it = std::upper_bound(jobs.begin(), jobs.end(), job, [](const std::shared_ptr<JobState>& lhs, const std::shared_ptr<JobState>& rhs) {
+                    return lhs->priority > rhs->priority;
+                });
+                jobs.insert(it, job);
             }
-        };
-
-        using GuiMenuItem = std::shared_ptr<MenuItem>;
-        using GuiMenuItemPtr = MenuItem *;
 
-        class Menu : public Object
-        {
-        private:
-            std::string m_name;
-            std::vector<GuiMenuItem> m_items;
-        
-        public:
-            Menu(const std::string& name)
-                : m_name(name)
+            static JobHandle make_handle(const std::shared_ptr<JobState>& job)
             {
+                JobHandle handle;
+                handle.m_state = job;
+                return handle;
             }
 
-            virtual void update() override
+            // Releases an in-flight slot, and the job's entry in m_dispatched, even when the work
+            // running on the pool throws.
+            struct FlightGuard
             {
-                if (ImGui::BeginMenu(m_name.c_str()))
+                Scheduler& scheduler;
+                std::shared_ptr<JobState> job;
+
+                ~FlightGuard()
                 {
-                    for (auto& item : m_items)
+                    std::lock_guard<std::mutex> lock(scheduler.m_flight_mutex);
+                    if (job)
                     {
-                        item->update();
+                        auto& dispatched = scheduler.m_dispatched;
+                        dispatched.erase(std::find(dispatched.begin(), dispatched.end(), job));
                     }
-
-                    ImGui::EndMenu();
+                    scheduler.m_in_flight--;
+                    scheduler.m_flight_done.notify_all();
                 }
+            };
+
+            // nullptr stands for the global pool, which is only started once work is submitted.
+            ThreadPool& pool()
+            {
+                if (m_pool == nullptr)
+                    m_pool = &ThreadPool::instance();
+                if (m_max_in_flight == 0)
+                    m_max_in_flight = m_pool->size();
+                return *m_pool;
             }
 
-            void add_item(const GuiMenuItem& item)
+            // Records a worker exception so that the next run() rethrows it on the UI thread.
+            void fail(const std::shared_ptr<JobState>& job, std::exception_ptr exception)
             {
-                m_items.push_back(item);
+                job->exception = exception;
+                job->finished = true;
+                std::lock_guard<std::mutex> lock(m_flight_mutex);
+                m_failed.push_back(job);
             }
 
-            void add_item(GuiMenuItemPtr item)
+            void dispatch_workers()
             {
-                m_items.push_back(GuiMenuItem(item));
+                m_worker_jobs.erase(std::remove_if(m_worker_jobs.begin(), m_worker_jobs.end(), [](const std::shared_ptr<JobState>& job) {
+                    return job->cancelled.load();
+                }), m_worker_jobs.end());
+                if (m_worker_jobs.empty())
+                    return;
+
+                ThreadPool& workers = pool();
+                std::lock_guard<std::mutex> lock(m_flight_mutex);
+                size_t dispatched = 0;
+                for (; dispatched < m_worker_jobs.size() && m_in_flight < m_max_in_flight; dispatched++)
+                {
+                    std::shared_ptr<JobState> job = m_worker_jobs[dispatched];
+                    m_in_flight++;
+                    m_dispatched.push_back(job);
+                    workers.submit([this, job] {
+                        FlightGuard guard{*this, job};
+                        try
+                        {
+                            while (!job->cancelled && !job->step())
+                            {
+                            }
+                            if (!job->cancelled)
+                                job->finished = true;
+                        }
+                        catch (...)
+                        {
+                            fail(job, std::current_exception());
+                        }
+                    });
+                }
+                m_worker_jobs.erase(m_worker_jobs.begin(), m_worker_jobs.begin() + dispatched);
             }
-        };
 
-        using GuiMenu = std::shared_ptr<Menu>;
-        using GuiMenuPtr = Menu *;
+            // Runs callback on the thread pool; the scheduler outlives it and so does keep_alive.
+            void run_detached(std::shared_ptr<void> keep_alive, std::function<void()> callback)
+            {
+                ThreadPool& workers = pool();
+                {
+                    std::lock_guard<std::mutex> lock(m_flight_mutex);
+                    m_in_flight++;
+                }
+                workers.submit([this, keep_alive, callback] {
+                    FlightGuard guard{*this, nullptr};
+                    try
+                    {
+                        callback();
+                    }
+                    catch (...)
+                    {
+                        fail(std::make_shared<JobState>(), std::current_exception());
+                    }
+                });
+            }
 
-        class MenuBar : public Object
-        {
-        private:
-            std::vector<GuiMenu> m_menus;
+#ifdef EASYDEAR_HAS_COROUTINES
+            friend class Task;
+#endif
 
         public:
-            MenuBar() = default;
-            virtual ~MenuBar() = default;
-
-            virtual void update() override
+            // Makes a scheduler reachable through current() for the lifetime of the scope.
+            class Scope
             {
-                if (ImGui::BeginMenuBar())
+            private:
+                Scheduler *m_previous;
+
+            public:
+                Scope(Scheduler& scheduler)
+                    : m_previous(current_slot())
                 {
-                    for (auto& menu : m_menus)
-                    {
-                        menu->update();
-                    }
+                    current_slot() = &scheduler;
+                }
 
-                    ImGui::EndMenuBar();
+                ~Scope()
+                {
+                    current_slot() = m_previous;
                 }
-            }
+            };
 
-            void add_menu(const GuiMenu& menu)
+            Scheduler() = default;
+            Scheduler(const Scheduler&) = delete;
+            Scheduler& operator=(const Scheduler&) = delete;
+
+            ~Scheduler()
             {
-                m_menus.push_back(menu);
+                cancel_all();
+                std::unique_lock<std::mutex> lock(m_flight_mutex);
+                m_flight_done.wait(lock, [this] { return m_in_flight == 0; });
             }
 
-            void add_menu(GuiMenuPtr menu)
+            // The scheduler of the Window being updated on this thread, or nullptr.
+            static Scheduler *current()
             {
-                m_menus.push_back(GuiMenu(menu));
+                return current_slot();
             }
-        };
-
-        using GuiMenuBar = std::shared_ptr<MenuBar>;
-        using GuiMenuBarPtr = MenuBar *;
 
-        class ColorEdit : public Object
-        {
-        private:
-            std::string m_name;
-            ImVec4 *m_color;
-            
-        
-        public:
-            ColorEdit(const std::string& name, ImVec4 *color)
-                : m_name(name), m_color(color)
+            // step performs one small slice of work on the UI thread and returns true once done.
+            // Higher priorities run first.
+            JobHandle schedule(const std::function<bool()>& step, int priority = 0)
             {
+                auto job = std::make_shared<JobState>();
+                job->step = step;
+                job->priority = priority;
+                insert_by_priority(m_jobs, job);
+                return make_handle(job);
             }
 
-            virtual void update() override
+            // Same as schedule() but step is called in a loop on the thread pool until it returns
+            // true or the job is cancelled. Pending worker jobs are dispatched by priority.
+            JobHandle schedule_worker(const std::function<bool()>& step, int priority = 0)
             {
-                ImGui::ColorEdit4(m_name.c_str(), &m_color->x);
+                auto job = std::make_shared<JobState>();
+                job->step = step;
+                job->priority = priority;
+                insert_by_priority(m_worker_jobs, job);
+                return make_handle(job);
             }
 
-            ColorEdit& set_name(const std::string& name)
+            // Runs callback on the UI thread during the next run(). Safe to call from any thread.
+            void post(std::function<void()> callback)
             {
-                m_name = name;
-                return *this;
+                std::lock_guard<std::mutex> lock(m_posted_mutex);
+                m_posted.push_back(std::move(callback));
             }
 
-            ColorEdit& set_color(ImVec4 *color)
+            // Runs posted callbacks, then UI-thread jobs until budget (in seconds) is spent.
+            // At least one step runs per call so that every job makes progress. An exception
+            // thrown by a worker job is rethrown here, one per call.
+            void run(double budget)
             {
-                m_color = color;
-                return *this;
-            }
-        };
+                m_frame++;
+                m_deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(budget));
 
-        using GuiColorEdit = std::shared_ptr<ColorEdit>;
-        using GuiColorEditPtr = ColorEdit *;
+                {
+                    std::lock_guard<std::mutex> lock(m_posted_mutex);
+                    m_running_posted.swap(m_posted);
+                }
+                for (auto& callback : m_running_posted)
+                {
+                    callback();
+                }
+                m_running_posted.clear();
 
-        class PlotLines : public Object
-        {
-        private:
-            std::string m_name;
-            std::vector<float> m_values;
-            int m_values_offset = 0;
-            std::string m_overlay_text = "";
-            float m_scale_min = FLT_MAX;
-            float m_scale_max = FLT_MAX;
-            ImVec2 m_graph_size = ImVec2(0, 0);
-            int m_stride = sizeof(float);
-        
-        public:
-            PlotLines(const std::string& name, const std::vector<float>& values)
-                : m_name(name), m_values(values)
-            {
+                dispatch_workers();
+
+                m_running.assign(m_jobs.begin(), m_jobs.end());
+                bool progressed = false;
+                for (size_t i = 0; i < m_running.size();)
+                {
+                    JobState& job = *m_running[i];
+                    if (job.cancelled || job.finished)
+                    {
+                        i++;
+                        continue;
+                    }
+                    if (progressed && over_budget())
+                        break;
+
+                    m_yielded = false;
+                    if (job.step())
+                        job.finished = true;
+                    if (job.finished || m_yielded)
+                        i++;
+                    progressed |= !m_yielded;
+                }
+                m_running.clear();
+
+                m_jobs.erase(std::remove_if(m_jobs.begin(), m_jobs.end(), [](const std::shared_ptr<JobState>& job) {
+                    return job->cancelled || job->finished;
+                }), m_jobs.end());
+
+                std::shared_ptr<JobState> failed;
+                {
+                    std::lock_guard<std::mutex> lock(m_flight_mutex);
+                    if (!m_failed.empty())
+                    {
+                        failed = std::move(m_failed.front());
+                        m_failed.erase(m_failed.begin());
+                    }
+                }
+                if (failed)
+                    std::rethrow_exception(failed->exception);
             }
 
-            virtual void update() override
+            // Called from a UI-thread job step: the job is not stepped again before the next run().
+            void yield_frame()
             {
-                ImGui::PlotLines(m_name.c_str(), &m_values[0], m_values.size(), m_values_offset, m_overlay_text.c_str(), m_scale_min, m_scale_max, m_graph_size, m_stride);
+                m_yielded = true;
             }
 
-            PlotLines& set_values_offset(int values_offset)
+            bool over_budget() const
             {
-                m_values_offset = values_offset;
-                return *this;
+                return std::chrono::steady_clock::now() >= m_deadline;
             }
 
-            PlotLines& set_overlay_text(const std::string& overlay_text)
+            uint64_t get_frame() const
             {
-                m_overlay_text = overlay_text;
-                return *this;
+                return m_frame;
             }
 
-            PlotLines& set_scale_min(float scale_min)
+            void cancel_all()
             {
-                m_scale_min = scale_min;
-                return *this;
+                for (auto& job : m_jobs)
+                {
+                    job->cancelled = true;
+                }
+                for (auto& job : m_worker_jobs)
+                {
+                    job->cancelled = true;
+                }
+                m_jobs.clear();
+                m_worker_jobs.clear();
+
+                // Jobs already on the pool stop at their next step.
+                std::lock_guard<std::mutex> lock(m_flight_mutex);
+                for (auto& job : m_dispatched)
+                {
+                    job->cancelled = true;
+                }
             }
 
-            PlotLines& set_scale_max(float scale_max)
+            // nullptr selects the global pool, a max_in_flight of 0 the size of the pool.
+            Scheduler& set_thread_pool(ThreadPool *pool, size_t max_in_flight = 0)
             {
-                m_scale_max = scale_max;
+                m_pool = pool;
+                m_max_in_flight = max_in_flight;
                 return *this;
             }
 
-            PlotLines& set_graph_size(const ImVec2& graph_size)
+            size_t get_pending_count() const
             {
-                m_graph_size = graph_size;
-                return *this;
+                return m_jobs.size() + m_worker_jobs.size();
             }
 
-            PlotLines& set_stride(int stride)
+            // True when nothing is scheduled, posted or still running on the pool.
+            bool is_idle()
             {
-                m_stride = stride;
-                return *this;
+                if (!m_jobs.empty() || !m_worker_jobs.empty())
+                    return false;
+                {
+                    std::lock_guard<std::mutex> lock(m_posted_mutex);
+                    if (!m_posted.empty())
+                        return false;
+                }
+                std::lock_guard<std::mutex> lock(m_flight_mutex);
+                return m_in_flight == 0;
             }
-        };
 
-        using GuiPlotLines = std::shared_ptr<PlotLines>;
-        using GuiPlotLinesPtr = PlotLines *;
+#ifdef EASYDEAR_HAS_COROUTINES
+            JobHandle spawn(Task task, int priority = 0);
+#endif
+        };
 
-        class Histogram : public Object
+#ifdef EASYDEAR_HAS_COROUTINES
+        // Coroutine driven by a Scheduler as a UI-thread job. It starts on the next run() and
+        // suspends with co_await next_frame(), yield_if_over_budget(), resume_on_worker() and
+        // resume_on_ui(). Exceptions are rethrown from Scheduler::run().
+        class Task
         {
-        private:
-            std::string m_name;
-            std::vector<float> m_values;
-            int m_values_offset = 0;
-            std::string m_overlay_text = "";
-            float m_scale_min = FLT_MAX;
-            float m_scale_max = FLT_MAX;
-            ImVec2 m_graph_size = ImVec2(0, 0);
-            int m_stride = sizeof(float);
-
         public:
+            struct promise_type;
 
-            Histogram(const std::string& name, const std::vector<float>& values)
-                : m_name(name), m_values(values)
-            {
-            }
-
-            virtual void update() override
+            // A coroutine that completes on a worker hands itself back to the UI thread only
+            // once it is suspended for good, so that done() and exception are safe to read there.
+            struct FinalAwaiter
             {
-                ImGui::PlotHistogram(m_name.c_str(), &m_values[0], m_values.size(), m_values_offset, m_overlay_text.c_str(), m_scale_min, m_scale_max, m_graph_size, m_stride);
-            }
+                bool await_ready() const noexcept
+                {
+                    return false;
+                }
+
+                void await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+                {
+                    handle.promise().on_worker.store(false, std::memory_order_release);
+                }
+
+                void await_resume() noexcept
+                {
+                }
+            };
+
+            struct promise_type
+            {
+                Scheduler *scheduler = nullptr;
+                std::weak_ptr<void> job;
+                std::atomic<bool> on_worker{false};
+                std::atomic<uint64_t> wake_frame{0};
+                std::exception_ptr exception;
+
+                Task get_return_object()
+                {
+                    return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+                }
+
+                std::suspend_always initial_suspend() noexcept
+                {
+                    return {};
+                }
+
+                FinalAwaiter final_suspend() noexcept
+                {
+                    return {};
+                }
+
+                void return_void()
+                {
+                }
+
+                void unhandled_exception()
+                {
+                    exception = std::current_exception();
+                }
+
+                template <typename Awaiter>
+                Awaiter await_transform(Awaiter awaiter)
+                {
+                    awaiter.promise = this;
+                    return awaiter;
+                }
+            };
+
+            using Handle = std::coroutine_handle<promise_type>;
+
+            // Publishing on_worker = false hands the coroutine back to the UI thread, so it is
+            // the last thing an await_suspend does.
+            struct FrameAwaiter
+            {
+                bool only_over_budget;
+                promise_type *promise = nullptr;
+
+                bool await_ready() const
+                {
+                    return only_over_budget && (promise->on_worker || !promise->scheduler->over_budget());
+                }
+
+                void await_suspend(Handle)
+                {
+                    promise->wake_frame = promise->scheduler->get_frame() + 1;
+                    promise->on_worker = false;
+                }
+
+                void await_resume()
+                {
+                }
+            };
+
+            struct WorkerAwaiter
+            {
+                promise_type *promise = nullptr;
+
+                bool await_ready() const
+                {
+                    return promise->on_worker;
+                }
+
+                void await_suspend(Handle handle)
+                {
+                    promise->on_worker = true;
+                    promise->scheduler->run_detached(promise->job.lock(), [handle] { handle.resume(); });
+                }
+
+                void await_resume()
+                {
+                }
+            };
+
+            struct UiAwaiter
+            {
+                promise_type *promise = nullptr;
+
+                bool await_ready() const
+                {
+                    return !promise->on_worker;
+                }
+
+                void await_suspend(Handle)
+                {
+                    promise->wake_frame = 0;
+                    promise->on_worker = false;
+                }
+
+                void await_resume()
+                {
+                }
+            };
+
+        private:
+            Handle m_handle;
+
+            explicit Task(Handle handle)
+                : m_handle(handle)
+            {
+            }
+
+            friend class Scheduler;
+
+        public:
+            Task(Task&& other) noexcept
+                : m_handle(std::exchange(other.m_handle, nullptr))
+            {
+            }
+
+            Task& operator=(Task&& other) noexcept
+            {
+                if (this != &other)
+                {
+                    if (m_handle)
+                        m_handle.destroy();
+                    m_handle = std::exchange(other.m_handle, nullptr);
+                }
+                return *this;
+            }
+
+            Task(const Task&) = delete;
+            Task& operator=(const Task&) = delete;
+
+            ~Task()
+            {
+                if (m_handle)
+                    m_handle.destroy();
+            }
+        };
+
+        // Resumes at the next frame; from a worker thread this also hops back to the UI thread.
+        inline Task::FrameAwaiter next_frame()
+        {
+            return {false, nullptr};
+        }
+
+        // Suspends until the next frame only if the scheduler's frame budget is spent.
+        inline Task::FrameAwaiter yield_if_over_budget()
+        {
+            return {true, nullptr};
+        }
+
+        inline Task::WorkerAwaiter resume_on_worker()
+        {
+            return {nullptr};
+        }
+
+        inline Task::UiAwaiter resume_on_ui()
+        {
+            return {nullptr};
+        }
+
+        inline JobHandle Scheduler::spawn(Task task, int priority)
+        {
+            Task::Handle handle = std::exchange(task.m_handle, nullptr);
+            std::shared_ptr<void> owner(handle.address(), [](void *address) {
+                Task::Handle::from_address(address).destroy();
+            });
+
+            auto job = std::make_shared<JobState>();
+            job->priority = priority;
+            job->step = [this, handle, owner]() -> bool {
+                Task::promise_type& promise = handle.promise();
+                // While on_worker is set the coroutine may be running on another thread, so it
+                // is checked before anything else in the frame is read.
+                if (promise.on_worker.load(std::memory_order_acquire) || promise.wake_frame > get_frame())
+                {
+                    yield_frame();
+                    return false;
+                }
+                if (!handle.done())
+                {
+                    handle.resume();
+                    // A hop to a worker may already be running there: done() and exception
+                    // belong to that thread until its final or UI awaiter clears on_worker.
+                    if (promise.on_worker.load(std::memory_order_acquire))
+                    {
+                        yield_frame();
+                        return false;
+                    }
+                }
+                if (handle.done())
+                {
+                    if (promise.exception)
+                        std::rethrow_exception(std::exchange(promise.exception, nullptr));
+                    return true;
+                }
+                if (promise.wake_frame > get_frame())
+                    yield_frame();
+                return false;
+            };
+            handle.promise().scheduler = this;
+            handle.promise().job = job;
+            insert_by_priority(m_jobs, job);
+            return make_handle(job);
+        }
+#endif
+
+#if EASYDEAR_OWNERSHIP == EASYDEAR_OWNERSHIP_INTRUSIVE
+        template <typename T>
+        class IntrusivePtr;
+#endif
+
+        class RefCounted
+        {
+#if EASYDEAR_OWNERSHIP == EASYDEAR_OWNERSHIP_INTRUSIVE
+        private:
+            mutable uint32_t m_ref_count = 0;
+
+            template <typename T>
+            friend class IntrusivePtr;
+
+        protected:
+            RefCounted() = default;
+
+            RefCounted(const RefCounted&)
+            {
+            }
+
+            RefCounted& operator=(const RefCounted&)
+            {
+                return *this;
+            }
+#endif
+        };
+
+#if EASYDEAR_OWNERSHIP == EASYDEAR_OWNERSHIP_INTRUSIVE
+        // Single-threaded reference counting stored in the object itself (see RefCounted).
+        template <typename T>
+        class IntrusivePtr
+        {
+        private:
+            T *m_ptr = nullptr;
+
+            template <typename U>
+            friend class IntrusivePtr;
+
+            void retain() const
+            {
+                if (m_ptr)
+                    static_cast<const RefCounted *>(m_ptr)->m_ref_count++;
+            }
+
+            void release()
+            {
+                if (m_ptr && --static_cast<const RefCounted *>(m_ptr)->m_ref_count == 0)
+                    delete m_ptr;
+                m_ptr = nullptr;
+            }
+
+        public:
+            IntrusivePtr() = default;
+
+            IntrusivePtr(std::nullptr_t)
+            {
+            }
+
+            explicit IntrusivePtr(T *ptr)
+                : m_ptr(ptr)
+            {
+                retain();
+            }
+
+            IntrusivePtr(const IntrusivePtr& other)
+                : m_ptr(other.m_ptr)
+            {
+                retain();
+            }
+
+            IntrusivePtr(IntrusivePtr&& other) noexcept
+                : m_ptr(std::exchange(other.m_ptr, nullptr))
+            {
+            }
+
+            template <typename U, typename = std::enable_if_t<std::is_convertible_v<U *, T *>>>
+            IntrusivePtr(const IntrusivePtr<U>& other)
+                : m_ptr(other.m_ptr)
+            {
+                retain();
+            }
+
+            template <typename U, typename = std::enable_if_t<std::is_convertible_v<U *, T *>>>
+            IntrusivePtr(IntrusivePtr<U>&& other) noexcept
+                : m_ptr(std::exchange(other.m_ptr, nullptr))
+            {
+            }
+
+            ~IntrusivePtr()
+            {
+                release();
+            }
+
+            IntrusivePtr& operator=(IntrusivePtr other) noexcept
+            {
+                std::swap(m_ptr, other.m_ptr);
+                return *this;
+            }
+
+            void reset()
+            {
+                release();
+            }
+
+            T *get() const
+            {
+                return m_ptr;
+            }
+
+            T& operator*() const
+            {
+                return *m_ptr;
+            }
+
+            T *operator->() const
+            {
+                return m_ptr;
+            }
+
+            explicit operator bool() const
+            {
+                return m_ptr != nullptr;
+            }
+
+            bool operator==(const IntrusivePtr& other) const
+            {
+                return m_ptr == other.m_ptr;
+            }
+
+            bool operator!=(const IntrusivePtr& other) const
+            {
+                return m_ptr != other.m_ptr;
+            }
+        };
+
+        template <typename T>
+        using Ref = IntrusivePtr<T>;
+
+        template <typename T, typename... Args>
+        Ref<T> make_gui(Args&&... args)
+        {
+            return Ref<T>(new T(std::forward<Args>(args)...));
+        }
+#elif EASYDEAR_OWNERSHIP == EASYDEAR_OWNERSHIP_UNIQUE
+        template <typename T>
+        using Ref = std::unique_ptr<T>;
+
+        template <typename T, typename... Args>
+        Ref<T> make_gui(Args&&... args)
+        {
+            return std::make_unique<T>(std::forward<Args>(args)...);
+        }
+#else
+        template <typename T>
+        using Ref = std::shared_ptr<T>;
+
+        template <typename T, typename... Args>
+        Ref<T> make_gui(Args&&... args)
+        {
+            return std::make_shared<T>(std::forward<Args>(args)...);
+        }
+#endif
+
+        // Records widget update spans into per-thread lock-free rings and writes them as Chrome
+        // Trace Event JSON (chrome://tracing, Perfetto). Costs one relaxed load while disabled.
+        class Trace
+        {
+        private:
+            struct Event
+            {
+                uint64_t begin;
+                uint64_t end;
+                const std::type_info *type;
+                char name[40];
+            };
+
+            // Single producer (the owning thread), single consumer (write_json under the registry lock).
+            struct Ring
+            {
+                std::unique_ptr<Event[]> events;
+                size_t capacity;
+                uint32_t thread_id;
+                std::atomic<uint64_t> head{0};
+                std::atomic<uint64_t> tail{0};
+                std::atomic<uint64_t> dropped{0};
+            };
+
+            struct Registry
+            {
+                std::mutex mutex;
+                std::vector<std::shared_ptr<Ring>> rings;
+                size_t capacity = 1 << 16;
+            };
+
+            static Registry& registry()
+            {
+                static Registry value;
+                return value;
+            }
+
+            static std::atomic<bool>& enabled_flag()
+            {
+                static std::atomic<bool> value{false};
+                return value;
+            }
+
+            static Ring& local_ring()
+            {
+                static thread_local std::shared_ptr<Ring> ring;
+                if (!ring)
+                {
+                    Registry& reg = registry();
+                    std::lock_guard<std::mutex> lock(reg.mutex);
+                    ring = std::make_shared<Ring>();
+                    ring->capacity = reg.capacity;
+                    ring->events.reset(new Event[ring->capacity]);
+                    ring->thread_id = (uint32_t)reg.rings.size() + 1;
+                    reg.rings.push_back(ring);
+                }
+                return *ring;
+            }
+
+            class Writer
+            {
+            private:
+                FILE *m_file;
+                char m_buffer[1 << 16];
+                size_t m_size = 0;
+
+            public:
+                explicit Writer(FILE *file)
+                    : m_file(file)
+                {
+                }
+
+                ~Writer()
+                {
+                    flush();
+                }
+
+                void flush()
+                {
+                    fwrite(m_buffer, 1, m_size, m_file);
+                    m_size = 0;
+                }
+
+                void write(const char *data, size_t size)
+                {
+                    if (m_size + size > sizeof(m_buffer))
+                        flush();
+                    if (size > sizeof(m_buffer))
+                    {
+                        fwrite(data, 1, size, m_file);
+                        return;
+                    }
+                    memcpy(m_buffer + m_size, data, size);
+                    m_size += size;
+                }
+
+                void write(const char *text)
+                {
+                    write(text, strlen(text));
+                }
+
+                void write_escaped(const char *text)
+                {
+                    for (; *text; text++)
+                    {
+                        unsigned char c = *text;
+                        if (c == '"' || c == '\\')
+                        {
+                            char escaped[2] = {'\\', (char)c};
+                            write(escaped, 2);
+                        }
+                        else if (c < 0x20)
+                        {
+                            char escaped[8];
+                            write(escaped, snprintf(escaped, sizeof(escaped), "\\u%04x", c));
+                        }
+                        else
+                        {
+                            write((const char *)&c, 1);
+                        }
+                    }
+                }
+            };
+
+        public:
+            static bool is_enabled()
+            {
+                return enabled_flag().load(std::memory_order_relaxed);
+            }
+
+            static void set_enabled(bool enabled)
+            {
+                enabled_flag().store(enabled, std::memory_order_relaxed);
+            }
+
+            // Events kept per thread until the next write; applies to threads that record for the
+            // first time after the call. Events are dropped, not overwritten, when a ring is full.
+            static void set_capacity(size_t events_per_thread)
+            {
+                Registry& reg = registry();
+                std::lock_guard<std::mutex> lock(reg.mutex);
+                reg.capacity = std::max<size_t>(events_per_thread, 1);
+            }
+
+            static uint64_t now()
+            {
+                return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+            }
+
+            static void record(uint64_t begin, uint64_t end, const std::type_info& type, const std::string& name)
+            {
+                Ring& ring = local_ring();
+                uint64_t head = ring.head.load(std::memory_order_relaxed);
+                if (head - ring.tail.load(std::memory_order_acquire) >= ring.capacity)
+                {
+                    ring.dropped.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                Event& event = ring.events[head % ring.capacity];
+                event.begin = begin;
+                event.end = end;
+                event.type = &type;
+                size_t size = std::min(name.size(), sizeof(event.name) - 1);
+                memcpy(event.name, name.data(), size);
+                event.name[size] = '\0';
+                ring.head.store(head + 1, std::memory_order_release);
+            }
+
+            static std::string type_name(const std::type_info& type)
+            {
+                std::string name = type.name();
+#ifdef EASYDEAR_HAS_CXXABI
+                int status = 0;
+                char *demangled = abi::__cxa_demangle(name.c_str(), nullptr, nullptr, &status);
+                if (status == 0 && demangled)
+                    name = demangled;
+                free(demangled);
+#endif
+                size_t scope = name.rfind("::");
+                return scope == std::string::npos ? name : name.substr(scope + 2);
+            }
+
+            // Moves every recorded event into file as a Chrome Trace Event JSON document.
+            static void write_json(FILE *file)
+            {
+                Registry& reg = registry();
+                std::lock_guard<std::mutex> lock(reg.mutex);
+                std::unordered_map<const std::type_info *, std::string> type_names;
+                Writer writer(file);
+                char number[128];
+                bool first = true;
+
+                writer.write("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+                for (auto& ring : reg.rings)
+                {
+                    uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+                    uint64_t head = ring->head.load(std::memory_order_acquire);
+                    for (; tail != head; tail++)
+                    {
+                        const Event& event = ring->events[tail % ring->capacity];
+                        auto it = type_names.find(event.type);
+                        if (it == type_names.end())
+                            it = type_names.emplace(event.type, type_name(*event.type)).first;
+
+                        writer.write(first ? "\n{\"name\":\"" : ",\n{\"name\":\"");
+                        writer.write_escaped(event.name[0] ? event.name : it->second.c_str());
+                        writer.write("\",\"cat\":\"");
+                        writer.write_escaped(it->second.c_str());
+                        writer.write(number, snprintf(number, sizeof(number), "\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                            ring->thread_id, event.begin / 1000.0, (event.end - event.begin) / 1000.0));
+                        first = false;
+                    }
+                    ring->tail.store(tail, std::memory_order_release);
+                }
+                writer.write("\n]}\n");
+            }
+
+            static bool write_json(const std::string& path)
+            {
+                FILE *file = fopen(path.c_str(), "wb");
+                if (file == nullptr)
+                    return false;
+                write_json(file);
+                return fclose(file) == 0;
+            }
+
+            static uint64_t get_dropped_count()
+            {
+                Registry& reg = registry();
+                std::lock_guard<std::mutex> lock(reg.mutex);
+                uint64_t dropped = 0;
+                for (auto& ring : reg.rings)
+                {
+                    dropped += ring->dropped.load(std::memory_order_relaxed);
+                }
+                return dropped;
+            }
+        };
+
+        // Per-frame counters for the widget tree. Counters are single-writer (the UI thread) and
+        // bumped with relaxed loads and stores; per-widget timing only runs while enabled.
+        class Metrics
+        {
+        public:
+            static constexpr size_t SLOWEST_COUNT = 8;
+
+            // nanoseconds is self time: the time spent in nested widgets is not included.
+            struct WidgetCost
+            {
+                uint64_t nanoseconds;
+                const std::type_info *type;
+                char name[40];
+            };
+
+            // Fixed-bucket latency histogram in the Prometheus layout; safe to read from any thread.
+            struct Distribution
+            {
+                static constexpr size_t BUCKET_COUNT = 12;
+
+                std::atomic<uint64_t> buckets[BUCKET_COUNT + 1] = {};
+                std::atomic<uint64_t> sum{0};
+
+                static const double *bounds()
+                {
+                    static const double values[BUCKET_COUNT] = {0.0005, 0.001, 0.002, 0.004, 0.008, 0.016, 0.033, 0.066, 0.125, 0.25, 0.5, 1.0};
+                    return values;
+                }
+
+                void observe(uint64_t nanoseconds)
+                {
+                    size_t bucket = 0;
+                    while (bucket < BUCKET_COUNT && nanoseconds > bounds()[bucket] * 1e9)
+                    {
+                        bucket++;
+                    }
+                    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+                    sum.fetch_add(nanoseconds, std::memory_order_relaxed);
+                }
+            };
+
+            struct Frame
+            {
+                uint64_t index = 0;
+                float frame_time = 0.0f;
+                uint64_t widgets = 0;
+                uint64_t culled = 0;
+                uint64_t allocations = 0;
+                size_t slowest_count = 0;
+                WidgetCost slowest[SLOWEST_COUNT];
+            };
+
+        private:
+            static constexpr size_t TYPE_SLOTS = 256;
+
+            struct TypeCost
+            {
+                std::atomic<const std::type_info *> type{nullptr};
+                std::atomic<uint64_t> calls{0};
+                std::atomic<uint64_t> nanoseconds{0};
+            };
+
+            struct State
+            {
+                std::atomic<int> enabled{0};
+                std::atomic<uint64_t> widgets{0};
+                std::atomic<uint64_t> culled{0};
+                std::atomic<uint64_t> allocations{0};
+                std::atomic<uint64_t> widgets_total{0};
+                std::atomic<uint64_t> culled_total{0};
+                std::atomic<uint64_t> frames_total{0};
+                std::atomic<uint64_t> log_lines{0};
+                std::atomic<uint64_t> log_bytes{0};
+                Distribution frame_time;
+                Distribution fuzzy_search;
+                TypeCost types[TYPE_SLOTS];
+                uint64_t frame_allocations = 0;
+                int frame_index = -1;
+                Frame current;
+                Frame last;
+            };
+
+            static State& state()
+            {
+                static State value;
+                return value;
+            }
+
+            static void bump(std::atomic<uint64_t>& counter, uint64_t amount)
+            {
+                counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+            }
+
+        public:
+            static bool is_enabled()
+            {
+                return state().enabled.load(std::memory_order_relaxed) > 0;
+            }
+
+            // Enables per-widget timing (two clock reads per widget) for the slowest-widget list.
+            // Calls are counted, so every set_enabled(true) is undone by one set_enabled(false).
+            static void set_enabled(bool enabled)
+            {
+                std::atomic<int>& count = state().enabled;
+                if (enabled)
+                {
+                    count.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                int current = count.load(std::memory_order_relaxed);
+                while (current > 0 && !count.compare_exchange_weak(current, current - 1, std::memory_order_relaxed))
+                {
+                }
+            }
+
+            static void count_widget()
+            {
+                bump(state().widgets, 1);
+            }
+
+            static void add_culled(uint64_t count)
+            {
+                bump(state().culled, count);
+            }
+
+            // Called from any thread by the operator new replacement of EASYDEAR_COUNT_ALLOCATIONS.
+            static void note_allocation()
+            {
+                state().allocations.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            static void note_log_ingest(uint64_t lines, uint64_t bytes)
+            {
+                state().log_lines.fetch_add(lines, std::memory_order_relaxed);
+                state().log_bytes.fetch_add(bytes, std::memory_order_relaxed);
+            }
+
+            static void observe_fuzzy_search(uint64_t nanoseconds)
+            {
+                state().fuzzy_search.observe(nanoseconds);
+            }
+
+            // Open addressing keyed on the type_info address; slots are claimed once and never freed.
+            static void record_type(uint64_t nanoseconds, const std::type_info& type)
+            {
+                State& s = state();
+                size_t slot = (std::hash<const void *>()(&type) >> 4) % TYPE_SLOTS;
+                for (size_t probe = 0; probe < TYPE_SLOTS; probe++, slot = (slot + 1) % TYPE_SLOTS)
+                {
+                    TypeCost& cost = s.types[slot];
+                    const std::type_info *current = cost.type.load(std::memory_order_acquire);
+                    if (current == nullptr && cost.type.compare_exchange_strong(current, &type, std::memory_order_acq_rel))
+                        current = &type;
+                    if (current == &type)
+                    {
+                        bump(cost.calls, 1);
+                        bump(cost.nanoseconds, nanoseconds);
+                        return;
+                    }
+                }
+            }
+
+            static void record_widget(uint64_t nanoseconds, const std::type_info& type, const std::string& name)
+            {
+                record_type(nanoseconds, type);
+                Frame& frame = state().current;
+                size_t index = frame.slowest_count;
+                if (index == SLOWEST_COUNT)
+                {
+                    if (nanoseconds <= frame.slowest[SLOWEST_COUNT - 1].nanoseconds)
+                        return;
+                    index--;
+                }
+                else
+                {
+                    frame.slowest_count++;
+                }
+                for (; index > 0 && frame.slowest[index - 1].nanoseconds < nanoseconds; index--)
+                {
+                    frame.slowest[index] = frame.slowest[index - 1];
+                }
+                WidgetCost& cost = frame.slowest[index];
+                cost.nanoseconds = nanoseconds;
+                cost.type = &type;
+                size_t size = std::min(name.size(), sizeof(cost.name) - 1);
+                memcpy(cost.name, name.data(), size);
+                cost.name[size] = '\0';
+            }
+
+            // Closes the current frame once per ImGui frame; Window::update() calls it.
+            static void new_frame()
+            {
+                State& s = state();
+                int frame_index = ImGui::GetFrameCount();
+                if (frame_index == s.frame_index)
+                    return;
+                s.frame_index = frame_index;
+
+                uint64_t allocations = s.allocations.load(std::memory_order_relaxed);
+                s.current.index = (uint64_t)frame_index;
+                s.current.frame_time = ImGui::GetIO().DeltaTime;
+                s.current.widgets = s.widgets.exchange(0, std::memory_order_relaxed);
+                s.current.culled = s.culled.exchange(0, std::memory_order_relaxed);
+                s.current.allocations = allocations - s.frame_allocations;
+                s.frame_allocations = allocations;
+                s.last = s.current;
+                s.current.slowest_count = 0;
+
+                bump(s.frames_total, 1);
+                bump(s.widgets_total, s.last.widgets);
+                bump(s.culled_total, s.last.culled);
+                s.frame_time.observe((uint64_t)(s.last.frame_time * 1e9));
+            }
+
+            static const Frame& get_last_frame()
+            {
+                return state().last;
+            }
+
+            static uint64_t get_allocation_count()
+            {
+                return state().allocations.load(std::memory_order_relaxed);
+            }
+
+            static bool counts_allocations()
+            {
+#ifdef EASYDEAR_COUNT_ALLOCATIONS
+                return true;
+#else
+                return false;
+#endif
+            }
+
+            // Appends every cumulative counter in the Prometheus text exposition format (0.0.4).
+            // Only reads atomics, so it may run on any thread while the UI keeps updating.
+            static void write_prometheus(std::string& out)
+            {
+                State& s = state();
+                char line[256];
+                auto counter = [&](const char *name, const char *help, uint64_t value) {
+                    out.append(line, snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s counter\n%s %llu\n", name, help, name, name, (unsigned long long)value));
+                };
+                auto histogram = [&](const char *name, const char *help, const Distribution& distribution) {
+                    out.append(line, snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s histogram\n", name, help, name));
+                    uint64_t count = 0;
+                    for (size_t i = 0; i <= Distribution::BUCKET_COUNT; i++)
+                    {
+                        count += distribution.buckets[i].load(std::memory_order_relaxed);
+                        if (i < Distribution::BUCKET_COUNT)
+                            out.append(line, snprintf(line, sizeof(line), "%s_bucket{le=\"%g\"} %llu\n", name, Distribution::bounds()[i], (unsigned long long)count));
+                        else
+                            out.append(line, snprintf(line, sizeof(line), "%s_bucket{le=\"+Inf\"} %llu\n", name, (unsigned long long)count));
+                    }
+                    out.append(line, snprintf(line, sizeof(line), "%s_sum %.9f\n%s_count %llu\n", name, distribution.sum.load(std::memory_order_relaxed) / 1e9, name, (unsigned long long)count));
+                };
+
+                histogram("easydear_frame_seconds", "Time between frames.", s.frame_time);
+                counter("easydear_frames_total", "Frames seen by Window::update().", s.frames_total.load(std::memory_order_relaxed));
+                counter("easydear_widget_updates_total", "Widget update() calls.", s.widgets_total.load(std::memory_order_relaxed));
+                counter("easydear_widget_culled_total", "Widgets skipped by virtualized containers.", s.culled_total.load(std::memory_order_relaxed));
+                if (counts_allocations())
+                    counter("easydear_allocations_total", "Calls to operator new.", s.allocations.load(std::memory_order_relaxed));
+                counter("easydear_logger_lines_total", "Lines added to Logger widgets.", s.log_lines.load(std::memory_order_relaxed));
+                counter("easydear_logger_bytes_total", "Bytes added to Logger widgets.", s.log_bytes.load(std::memory_order_relaxed));
+                histogram("easydear_fuzzy_search_seconds", "FuzzyCombo filtering latency, from query change to results.", s.fuzzy_search);
+
+                out += "# HELP easydear_widget_update_seconds_total Time spent in update() by widget type (timing enabled only).\n"
+                       "# TYPE easydear_widget_update_seconds_total counter\n";
+                for (TypeCost& cost : s.types)
+                {
+                    if (const std::type_info *type = cost.type.load(std::memory_order_acquire))
+                        out.append(line, snprintf(line, sizeof(line), "easydear_widget_update_seconds_total{type=\"%s\"} %.9f\n", Trace::type_name(*type).c_str(), cost.nanoseconds.load(std::memory_order_relaxed) / 1e9));
+                }
+                out += "# HELP easydear_widget_update_calls_total Timed update() calls by widget type.\n"
+                       "# TYPE easydear_widget_update_calls_total counter\n";
+                for (TypeCost& cost : s.types)
+                {
+                    if (const std::type_info *type = cost.type.load(std::memory_order_acquire))
+                        out.append(line, snprintf(line, sizeof(line), "easydear_widget_update_calls_total{type=\"%s\"} %llu\n", Trace::type_name(*type).c_str(), (unsigned long long)cost.calls.load(std::memory_order_relaxed)));
+                }
+            }
+        };
+
+#ifdef EASYDEAR_HAS_SOCKETS
+        // Serves Metrics::write_prometheus() over HTTP on a Unix domain socket or loopback TCP port
+        // from a dedicated thread. Scrape with e.g. `curl --unix-socket <path> http://localhost/metrics`.
+        class MetricsExporter
+        {
+        private:
+            int m_socket = -1;
+            uint16_t m_port = 0;
+            std::string m_path;
+            std::atomic<bool> m_running{false};
+            std::thread m_thread;
+
+            static void send_all(int client, const char *data, size_t size)
+            {
+#ifdef MSG_NOSIGNAL
+                const int flags = MSG_NOSIGNAL;
+#else
+                const int flags = 0;
+#endif
+                while (size > 0)
+                {
+                    ssize_t sent = send(client, data, size, flags);
+                    if (sent <= 0)
+                        return;
+                    data += sent;
+                    size -= (size_t)sent;
+                }
+            }
+
+            static void serve_client(int client)
+            {
+                // The request is read only to let the client finish writing; every path gets metrics.
+                timeval timeout = {1, 0};
+                setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+                std::string request;
+                char buffer[1024];
+                while (request.size() < 8192 && request.find("\r\n\r\n") == std::string::npos)
+                {
+                    ssize_t received = recv(client, buffer, sizeof(buffer), 0);
+                    if (received <= 0)
+                        break;
+                    request.append(buffer, (size_t)received);
+                }
+
+                std::string body;
+                Metrics::write_prometheus(body);
+                char header[160];
+                int header_size = snprintf(header, sizeof(header),
+                    "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n", body.size());
+                send_all(client, header, (size_t)header_size);
+                send_all(client, body.data(), body.size());
+            }
+
+            void serve()
+            {
+                while (m_running.load(std::memory_order_acquire))
+                {
+                    pollfd descriptor = {m_socket, POLLIN, 0};
+                    if (poll(&descriptor, 1, 100) <= 0)
+                        continue;
+                    int client = accept(m_socket, nullptr, nullptr);
+                    if (client < 0)
+                        continue;
+#ifdef SO_NOSIGPIPE
+                    int one = 1;
+                    setsockopt(client, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+                    serve_client(client);
+                    close(client);
+                }
+            }
+
+            bool start(int fd)
+            {
+                if (fd < 0)
+                    return false;
+                if (::listen(fd, 8) != 0)
+                {
+                    close(fd);
+                    return false;
+                }
+                m_socket = fd;
+                m_running.store(true, std::memory_order_release);
+                m_thread = std::thread([this] { serve(); });
+                return true;
+            }
+
+        public:
+            MetricsExporter() = default;
+            MetricsExporter(const MetricsExporter&) = delete;
+            MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+            ~MetricsExporter()
+            {
+                stop();
+            }
+
+            // Replaces a stale socket file at path; fails if path exists and is not a socket.
+            bool listen_unix(const std::string& path)
+            {
+                stop();
+                sockaddr_un address = {};
+                if (path.size() >= sizeof(address.sun_path))
+                    return false;
+                address.sun_family = AF_UNIX;
+                memcpy(address.sun_path, path.c_str(), path.size() + 1);
+                struct stat info;
+                if (lstat(path.c_str(), &info) == 0)
+                {
+                    if (!S_ISSOCK(info.st_mode) || unlink(path.c_str()) != 0)
+                        return false;
+                }
+                int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+                if (fd < 0)
+                    return false;
+                if (bind(fd, (const sockaddr *)&address, sizeof(address)) != 0)
+                {
+                    close(fd);
+                    return false;
+                }
+                m_path = path;
+                return start(fd);
+            }
+
+            // Binds 127.0.0.1 only; port 0 picks a free port, see get_port().
+            bool listen_tcp(uint16_t port)
+            {
+                stop();
+                int fd = socket(AF_INET, SOCK_STREAM, 0);
+                if (fd < 0)
+                    return false;
+                int one = 1;
+                setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+                sockaddr_in address = {};
+                address.sin_family = AF_INET;
+                address.sin_port = htons(port);
+                address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+                socklen_t length = sizeof(address);
+                if (bind(fd, (const sockaddr *)&address, sizeof(address)) != 0 || getsockname(fd, (sockaddr *)&address, &length) != 0)
+                {
+                    close(fd);
+                    return false;
+                }
+                m_port = ntohs(address.sin_port);
+                return start(fd);
+            }
+
+            void stop()
+            {
+                m_running.store(false, std::memory_order_release);
+                if (m_thread.joinable())
+                    m_thread.join();
+                if (m_socket >= 0)
+                    close(m_socket);
+                m_socket = -1;
+                m_port = 0;
+                if (!m_path.empty())
+                    unlink(m_path.c_str());
+                m_path.clear();
+            }
+
+            bool is_running() const
+            {
+                return m_running.load(std::memory_order_acquire);
+            }
+
+            uint16_t get_port() const
+            {
+                return m_port;
+            }
+        };
+#endif
+
+        class MemoryReport;
+
+        // Raised when a widget's data changes outside update() so that a cached Window or Child
+        // does not replay stale output. A container owns one, hands it to its children and chains
+        // it to the flag of the container it is added to. set() may be called from any thread.
+        class ChangeFlag
+        {
+        private:
+            std::atomic<ChangeFlag *> m_parent{nullptr};
+            std::shared_ptr<ChangeFlag> m_parent_owner;
+
+        public:
+            std::atomic<bool> changed{false};
+
+            // UI thread only. The new parent is published before the old one is released.
+            void set_parent(const std::shared_ptr<ChangeFlag>& parent)
+            {
+                m_parent.store(parent.get(), std::memory_order_release);
+                m_parent_owner = parent;
+            }
+
+            void set()
+            {
+                for (ChangeFlag *flag = this; flag != nullptr; flag = flag->m_parent.load(std::memory_order_acquire))
+                {
+                    flag->changed.store(true, std::memory_order_release);
+                }
+            }
+
+            bool consume()
+            {
+                return changed.exchange(false, std::memory_order_acquire);
+            }
+        };
+
+        class Object : public RefCounted
+        {
+        private:
+            std::shared_ptr<ChangeFlag> m_change_flag;
+
+        protected:
+            const std::shared_ptr<ChangeFlag>& get_change_flag() const
+            {
+                return m_change_flag;
+            }
+
+        public:
+            Object() = default;
+            virtual ~Object() = default;
+
+            virtual void update() = 0;
+
+            // Called by the container the widget is added to; containers forward it to their children.
+            virtual void attach(const std::shared_ptr<ChangeFlag>& flag)
+            {
+                m_change_flag = flag;
+            }
+
+            // Makes the enclosing cached windows draw again on their next update.
+            void mark_changed() const
+            {
+                if (m_change_flag)
+                    m_change_flag->set();
+            }
+
+            virtual const std::string& get_name() const
+            {
+                static const std::string empty;
+                return empty;
+            }
+
+            // Adds the heap memory owned by the widget (not the widget object itself) to report and
+            // reports contained widgets through MemoryReport::report().
+            virtual void report_memory(MemoryReport& report) const;
+
+            // Releases spare capacity of containers holding more than max_slack times their size
+            // (1 compacts everything) and returns the number of bytes given back to the allocator.
+            virtual size_t trim(float max_slack)
+            {
+                (void)max_slack;
+                return 0;
+            }
+        };
+
+        using GuiObject = Ref<Object>;
+        using GuiObjectPtr = Object *;
+
+        // Containers update their children through this so that instrumentation sees every widget.
+        inline void update_object(Object& object)
+        {
+            Metrics::count_widget();
+            bool tracing = Trace::is_enabled();
+            if (!tracing && !Metrics::is_enabled())
+            {
+                object.update();
+                return;
+            }
+            // Time spent in nested update_object() calls, subtracted to get this widget's self time.
+            static thread_local uint64_t nested = 0;
+            uint64_t outer_nested = std::exchange(nested, 0);
+            uint64_t begin = Trace::now();
+            object.update();
+            uint64_t end = Trace::now();
+            uint64_t inclusive = end - begin;
+            if (tracing)
+                Trace::record(begin, end, typeid(object), object.get_name());
+            Metrics::record_widget(inclusive - std::min(nested, inclusive), typeid(object), object.get_name());
+            nested = outer_nested + inclusive;
+        }
+
+        // Heap footprint of a widget tree, per widget (pre-order, with depth) and per type.
+        // Callback captures larger than std::function's inline buffer live on the heap where
+        // their size cannot be observed, so callbacks are counted rather than sized.
+        class MemoryReport
+        {
+        public:
+            struct Widget
+            {
+                const std::type_info *type;
+                std::string name;
+                uint32_t depth;
+                size_t self_bytes;
+                size_t total_bytes;
+                uint32_t callbacks;
+            };
+
+            struct TypeTotal
+            {
+                const std::type_info *type;
+                size_t count;
+                size_t bytes;
+                uint32_t callbacks;
+            };
+
+        private:
+            std::vector<Widget> m_widgets;
+            std::vector<size_t> m_stack;
+
+        public:
+            static size_t bytes_of(const std::string& text)
+            {
+                const char *data = text.data();
+                bool local = data >= (const char *)&text && data < (const char *)(&text + 1);
+                return local ? 0 : text.capacity() + 1;
+            }
+
+            template <typename T>
+            static size_t bytes_of(const std::vector<T>& values)
+            {
+                size_t bytes = values.capacity() * sizeof(T);
+                if constexpr (std::is_same_v<T, std::string>)
+                {
+                    for (const std::string& value : values)
+                        bytes += bytes_of(value);
+                }
+                return bytes;
+            }
+
+            // Approximates the block layout of the common implementations (512-byte blocks).
+            template <typename T>
+            static size_t bytes_of(const std::deque<T>& values)
+            {
+                size_t per_block = std::max<size_t>(512 / sizeof(T), 1);
+                size_t blocks = (values.size() + per_block - 1) / per_block;
+                return blocks * per_block * sizeof(T) + (blocks + 8) * sizeof(void *);
+            }
+
+            MemoryReport& begin(const std::type_info& type, const std::string& name)
+            {
+                m_stack.push_back(m_widgets.size());
+                m_widgets.push_back({&type, name, (uint32_t)m_stack.size() - 1, 0, 0, 0});
+                return *this;
+            }
+
+            MemoryReport& add(size_t bytes)
+            {
+                if (!m_stack.empty())
+                    m_widgets[m_stack.back()].self_bytes += bytes;
+                return *this;
+            }
+
+            template <typename Signature>
+            MemoryReport& add_callback(const std::function<Signature>& callback)
+            {
+                if (callback && !m_stack.empty())
+                    m_widgets[m_stack.back()].callbacks++;
+                return *this;
+            }
+
+            MemoryReport& end()
+            {
+                Widget& widget = m_widgets[m_stack.back()];
+                m_stack.pop_back();
+                widget.total_bytes += widget.self_bytes;
+                if (!m_stack.empty())
+                    m_widgets[m_stack.back()].total_bytes += widget.total_bytes;
+                return *this;
+            }
+
+            MemoryReport& report(const Object& object)
+            {
+                begin(typeid(object), object.get_name());
+                object.report_memory(*this);
+                return end();
+            }
+
+            MemoryReport& clear()
+            {
+                m_widgets.clear();
+                m_stack.clear();
+                return *this;
+            }
+
+            const std::vector<Widget>& get_widgets() const
+            {
+                return m_widgets;
+            }
+
+            // Sorted by bytes, largest first.
+            std::vector<TypeTotal> get_type_totals() const
+            {
+                std::vector<TypeTotal> totals;
+                for (const Widget& widget : m_widgets)
+                {
+                    auto it = std::find_if(totals.begin(), totals.end(), [&widget](const TypeTotal& total) { return total.type == widget.type; });
+                    if (it == totals.end())
+                        it = totals.insert(totals.end(), {widget.type, 0, 0, 0});
+                    it->count++;
+                    it->bytes += widget.self_bytes;
+                    it->callbacks += widget.callbacks;
+                }
+                std::sort(totals.begin(), totals.end(), [](const TypeTotal& lhs, const TypeTotal& rhs) { return lhs.bytes > rhs.bytes; });
+                return totals;
+            }
+
+            size_t get_total_bytes() const
+            {
+                size_t bytes = 0;
+                for (const Widget& widget : m_widgets)
+                {
+                    bytes += widget.self_bytes;
+                }
+                return bytes;
+            }
+
+            // Heap used by the report itself.
+            size_t get_memory_bytes() const
+            {
+                size_t bytes = bytes_of(m_widgets) + bytes_of(m_stack);
+                for (const Widget& widget : m_widgets)
+                {
+                    bytes += bytes_of(widget.name);
+                }
+                return bytes;
+            }
+        };
+
+        inline void Object::report_memory(MemoryReport& report) const
+        {
+            report.add(MemoryReport::bytes_of(get_name()));
+        }
+
+        class MemoryTrim
+        {
+        public:
+            template <typename T>
+            static size_t shrink(std::vector<T>& values, float max_slack)
+            {
+                size_t capacity = values.capacity();
+                if (capacity == 0 || capacity <= values.size() * max_slack)
+                    return 0;
+                values.shrink_to_fit();
+                return (capacity - values.capacity()) * sizeof(T);
+            }
+
+            static size_t shrink(std::string& text, float max_slack)
+            {
+                size_t capacity = text.capacity();
+                if (capacity <= text.size() * max_slack)
+                    return 0;
+                text.shrink_to_fit();
+                return capacity - text.capacity();
+            }
+
+            // A deque frees its blocks as it shrinks; only full compaction rebuilds its block map.
+            template <typename T>
+            static size_t shrink(std::deque<T>& values, float max_slack)
+            {
+                if (max_slack <= 1.0f)
+                    values.shrink_to_fit();
+                return 0;
+            }
+
+            // Hands freed heap pages back to the OS, across all malloc arenas on glibc.
+            static void release_to_os()
+            {
+#if defined(__GLIBC__)
+                malloc_trim(0);
+#elif defined(_WIN32)
+                _heapmin();
+#endif
+            }
+        };
+
+        // Hashes the vertices, indices and commands ImGui generated for every window. Capture the
+        // checksums of an optimized run and of a run in reference mode (no draw caching, no Child
+        // virtualization) over the same input, then compare() reports the first diverging window.
+        class DrawChecksum
+        {
+        public:
+            struct Entry
+            {
+                std::string window;
+                uint64_t hash;
+            };
+
+        private:
+            std::vector<std::vector<Entry>> m_frames;
+
+            static std::atomic<bool>& reference_flag()
+            {
+                static std::atomic<bool> value{false};
+                return value;
+            }
+
+        public:
+            static bool is_reference_mode()
+            {
+                return reference_flag().load(std::memory_order_relaxed);
+            }
+
+            static void set_reference_mode(bool reference)
+            {
+                reference_flag().store(reference, std::memory_order_relaxed);
+            }
+
+            static uint64_t hash(const void *data, size_t size, uint64_t seed)
+            {
+                const uint8_t *bytes = (const uint8_t *)data;
+                uint64_t value = seed;
+                for (; size >= 8; bytes += 8, size -= 8)
+                {
+                    uint64_t word;
+                    memcpy(&word, bytes, 8);
+                    value = (value ^ word) * 0x100000001b3ull;
+                    value ^= value >> 29;
+                }
+                for (; size > 0; bytes++, size--)
+                {
+                    value = (value ^ *bytes) * 0x100000001b3ull;
+                }
+                return value;
+            }
+
+            static uint64_t hash_draw_list(const ImDrawList& list)
+            {
+                uint64_t value = 0xcbf29ce484222325ull;
+                value = hash(list.VtxBuffer.Data, list.VtxBuffer.Size * sizeof(ImDrawVert), value);
+                value = hash(list.IdxBuffer.Data, list.IdxBuffer.Size * sizeof(ImDrawIdx), value);
+                for (const ImDrawCmd& command : list.CmdBuffer)
+                {
+                    // Callback pointers differ between runs; only whether one is present matters.
+                    struct
+                    {
+                        ImVec4 clip_rect;
+                        uint64_t texture;
+                        uint32_t vertex_offset;
+                        uint32_t index_offset;
+                        uint32_t element_count;
+                        uint32_t has_callback;
+                    } fields = {command.ClipRect, (uint64_t)(uintptr_t)command.GetTexID(), command.VtxOffset, command.IdxOffset, command.ElemCount, command.UserCallback != nullptr};
+                    value = hash(&fields, sizeof(fields), value);
+                }
+                return value;
+            }
+
+            // Call after ImGui::Render() with ImGui::GetDrawData().
+            DrawChecksum& capture(const ImDrawData *data)
+            {
+                m_frames.emplace_back();
+                if (data == nullptr)
+                    return *this;
+                for (int i = 0; i < data->CmdListsCount; i++)
+                {
+                    const ImDrawList *list = data->CmdLists[i];
+                    m_frames.back().push_back({list->_OwnerName ? list->_OwnerName : "", hash_draw_list(*list)});
+                }
+                return *this;
+            }
+
+            DrawChecksum& clear()
+            {
+                m_frames.clear();
+                return *this;
+            }
+
+            size_t get_frame_count() const
+            {
+                return m_frames.size();
+            }
+
+            const std::vector<Entry>& get_frame(size_t index) const
+            {
+                return m_frames[index];
+            }
+
+            // Index of the first frame that differs from other, or SIZE_MAX when all frames match.
+            size_t compare(const DrawChecksum& other, std::string *report = nullptr) const
+            {
+                size_t frames = std::max(m_frames.size(), other.m_frames.size());
+                for (size_t frame = 0; frame < frames; frame++)
+                {
+                    if (frame >= m_frames.size() || frame >= other.m_frames.size())
+                    {
+                        if (report)
+                            *report = "frame " + std::to_string(frame) + ": missing in one capture";
+                        return frame;
+                    }
+                    const std::vector<Entry>& lhs = m_frames[frame];
+                    const std::vector<Entry>& rhs = other.m_frames[frame];
+                    for (size_t i = 0; i < std::max(lhs.size(), rhs.size()); i++)
+                    {
+                        if (i < lhs.size() && i < rhs.size() && lhs[i].window == rhs[i].window && lhs[i].hash == rhs[i].hash)
+                            continue;
+                        if (report)
+                            *report = "frame " + std::to_string(frame) + ": window '" + (i < lhs.size() ? lhs[i].window : rhs[i].window) + "' differs";
+                        return frame;
+                    }
+                }
+                return SIZE_MAX;
+            }
+        };
+
+        class DrawCache
+        {
+        private:
+            struct Command
+            {
+                ImVec4 clip_rect;
+                ImTextureID texture;
+                uint32_t idx_count;
+                uint32_t vtx_count;
+                bool base_clip;
+            };
+
+            std::vector<ImDrawVert> m_vertices;
+            std::vector<ImDrawIdx> m_indices;
+            std::vector<Command> m_commands;
+            ImDrawList *m_list = nullptr;
+            int m_cmd_begin = 0;
+            int m_vtx_begin = 0;
+            int m_idx_begin = 0;
+            unsigned int m_windows_begin = 0;
+            ImVec4 m_base_clip;
+            ImVec2 m_origin = ImVec2(0, 0);
+            ImVec2 m_size = ImVec2(0, 0);
+            ImVec2 m_window_pos = ImVec2(0, 0);
+            ImVec2 m_window_size = ImVec2(0, 0);
+            ImVec2 m_window_scroll = ImVec2(0, 0);
+            uint32_t m_generation = 0;
+            bool m_valid = false;
+            bool m_settling = false;
+
+            static std::atomic<uint32_t>& generation()
+            {
+                static std::atomic<uint32_t> value{0};
+                return value;
+            }
+
+            static unsigned int& window_counter()
+            {
+                static unsigned int value = 0;
+                return value;
+            }
+
+            static bool same_rect(const ImVec4& lhs, const ImVec4& rhs)
+            {
+                return lhs.x == rhs.x && lhs.y == rhs.y && lhs.z == rhs.z && lhs.w == rhs.w;
+            }
+
+            static bool same_vec(const ImVec2& lhs, const ImVec2& rhs)
+            {
+                return lhs.x == rhs.x && lhs.y == rhs.y;
+            }
+
+            // Clip rects are recorded in screen space, so the recording only holds for the
+            // window placement, size and scroll it was made with.
+            bool same_window() const
+            {
+                return same_vec(ImGui::GetWindowPos(), m_window_pos) && same_vec(ImGui::GetWindowSize(), m_window_size)
+                    && same_vec(ImVec2(ImGui::GetScrollX(), ImGui::GetScrollY()), m_window_scroll);
+            }
+
+        public:
+            // Widgets that open their own ImGui window call this so that a recording around
+            // them is discarded: their output goes to another draw list and cannot be replayed.
+            static void note_window()
+            {
+                window_counter()++;
+            }
+
+            // Invalidates every cache, e.g. after changing data shared by several panels.
+            static void invalidate_all()
+            {
+                generation()++;
+            }
+
+            void invalidate()
+            {
+                m_valid = false;
+            }
+
+            bool is_valid() const
+            {
+                return m_valid && m_generation == generation();
+            }
+
+            size_t get_memory_bytes() const
+            {
+                return MemoryReport::bytes_of(m_vertices) + MemoryReport::bytes_of(m_indices) + MemoryReport::bytes_of(m_commands);
+            }
+
+            size_t trim(float max_slack)
+            {
+                return MemoryTrim::shrink(m_vertices, max_slack) + MemoryTrim::shrink(m_indices, max_slack) + MemoryTrim::shrink(m_commands, max_slack);
+            }
+
+            void begin_record()
+            {
+                m_list = ImGui::GetWindowDrawList();
+                m_cmd_begin = std::max(m_list->CmdBuffer.Size - 1, 0);
+                m_vtx_begin = m_list->VtxBuffer.Size;
+                m_idx_begin = m_list->IdxBuffer.Size;
+                m_windows_begin = window_counter();
+                m_origin = ImGui::GetCursorScreenPos();
+                ImVec2 clip_min = m_list->GetClipRectMin();
+                ImVec2 clip_max = m_list->GetClipRectMax();
+                m_base_clip = ImVec4(clip_min.x, clip_min.y, clip_max.x, clip_max.y);
+            }
+
+            void end_record()
+            {
+                m_valid = false;
+                m_vertices.clear();
+                m_indices.clear();
+                m_commands.clear();
+                if (window_counter() != m_windows_begin)
+                    return;
+
+                float max_x = m_origin.x;
+                int idx_end = m_list->IdxBuffer.Size;
+                for (int i = m_cmd_begin; i < m_list->CmdBuffer.Size; i++)
+                {
+                    const ImDrawCmd& cmd = m_list->CmdBuffer[i];
+                    int first = std::max((int)cmd.IdxOffset, m_idx_begin);
+                    int last = std::min((int)(cmd.IdxOffset + cmd.ElemCount), idx_end);
+                    if (last <= first)
+                        continue;
+                    if (cmd.UserCallback != nullptr)
+                        return;
+
+                    unsigned int vtx_min = UINT_MAX;
+                    unsigned int vtx_max = 0;
+                    for (int j = first; j < last; j++)
+                    {
+                        unsigned int vtx = cmd.VtxOffset + m_list->IdxBuffer[j];
+                        vtx_min = std::min(vtx_min, vtx);
+                        vtx_max = std::max(vtx_max, vtx);
+                    }
+                    if (vtx_min < (unsigned int)m_vtx_begin)
+                        return;
+
+                    for (int j = first; j < last; j++)
+                    {
+                        m_indices.push_back((ImDrawIdx)(cmd.VtxOffset + m_list->IdxBuffer[j] - vtx_min));
+                    }
+                    for (unsigned int v = vtx_min; v <= vtx_max; v++)
+                    {
+                        m_vertices.push_back(m_list->VtxBuffer[v]);
+                        max_x = std::max(max_x, m_list->VtxBuffer[v].pos.x);
+                    }
+                    m_commands.push_back({cmd.ClipRect, cmd.TextureId, (uint32_t)(last - first), vtx_max - vtx_min + 1, same_rect(cmd.ClipRect, m_base_clip)});
+                }
+
+                ImVec2 end = ImGui::GetCursorScreenPos();
+                m_size = ImVec2(max_x - m_origin.x, std::max(end.y - m_origin.y - ImGui::GetStyle().ItemSpacing.y, 0.0f));
+                m_window_pos = ImGui::GetWindowPos();
+                m_window_size = ImGui::GetWindowSize();
+                m_window_scroll = ImVec2(ImGui::GetScrollX(), ImGui::GetScrollY());
+                m_generation = generation();
+                m_valid = true;
+            }
+
+            // Appends the recorded commands to the current window and reserves the recorded layout
+            // size. Recordings are only replayed at the window placement and scroll they were
+            // made with (see same_window()), so vertices and clip rects are copied unchanged.
+            void replay()
+            {
+                ImDrawList *list = ImGui::GetWindowDrawList();
+                const ImDrawVert *vtx = m_vertices.data();
+                const ImDrawIdx *idx = m_indices.data();
+                for (auto& cmd : m_commands)
+                {
+                    if (!cmd.base_clip)
+                        list->PushClipRect(ImVec2(cmd.clip_rect.x, cmd.clip_rect.y), ImVec2(cmd.clip_rect.z, cmd.clip_rect.w), true);
+                    list->PushTextureID(cmd.texture);
+                    list->PrimReserve((int)cmd.idx_count, (int)cmd.vtx_count);
+                    unsigned int base = list->_VtxCurrentIdx;
+                    memcpy(list->_VtxWritePtr, vtx, cmd.vtx_count * sizeof(ImDrawVert));
+                    for (uint32_t i = 0; i < cmd.idx_count; i++)
+                    {
+                        list->_IdxWritePtr[i] = (ImDrawIdx)(base + idx[i]);
+                    }
+                    list->_VtxWritePtr += cmd.vtx_count;
+                    list->_IdxWritePtr += cmd.idx_count;
+                    list->_VtxCurrentIdx += cmd.vtx_count;
+                    vtx += cmd.vtx_count;
+                    idx += cmd.idx_count;
+                    list->PopTextureID();
+                    if (!cmd.base_clip)
+                        list->PopClipRect();
+                }
+                ImGui::Dummy(m_size);
+            }
+
+            // Replays the recording when nothing changed since it was made, otherwise runs submit
+            // and records it. Content stays live while the window is hovered or has an active
+            // item, and for one more frame afterwards so that hover highlights are not cached.
+            // Owners set dirty when a widget reports a change (Object::mark_changed()); data the
+            // widgets only point to needs dirty, invalidate() or invalidate_all() from the caller.
+            template <typename F>
+            void update(bool& dirty, F&& submit)
+            {
+                if (DrawChecksum::is_reference_mode())
+                {
+                    dirty = false;
+                    submit();
+                    return;
+                }
+                bool interacting = ImGui::IsWindowHovered(ImGuiHoveredFlags_ChildWindows | ImGuiHoveredFlags_AllowWhenBlockedByActiveItem)
+                    || (ImGui::IsWindowFocused(ImGuiFocusedFlags_ChildWindows) && ImGui::IsAnyItemActive());
+                if (is_valid() && !dirty && !interacting && !m_settling && same_window())
+                {
+                    replay();
+                    return;
+                }
+
+                m_settling = interacting;
+                dirty = false;
+                begin_record();
+                submit();
+                end_record();
+            }
+        };
+
+        class Window : public RefCounted
+        {
+        private:
+            std::vector<GuiObject> m_objects;
+            std::string m_name;
+            bool m_open = true;
+            ImGuiWindowFlags m_flags = 0;
+            bool m_cached = false;
+            bool m_dirty = true;
+            DrawCache m_cache;
+            double m_frame_budget = 0.002;
+            double m_trim_idle_seconds = 0.0;
+            float m_trim_max_slack = 4.0f;
+            double m_trim_last_activity = 0.0;
+            bool m_trimmed = false;
+            bool m_jobs_active = false;
+            std::shared_ptr<ChangeFlag> m_change_flag = std::make_shared<ChangeFlag>();
+            Scheduler m_scheduler;
+
+            void trim_if_idle()
+            {
+                double now = ImGui::GetTime();
+                bool interacting = ImGui::IsWindowHovered(ImGuiHoveredFlags_ChildWindows | ImGuiHoveredFlags_AllowWhenBlockedByActiveItem)
+                    || (ImGui::IsWindowFocused(ImGuiFocusedFlags_ChildWindows) && ImGui::IsAnyItemActive());
+                if (interacting)
+                {
+                    m_trim_last_activity = now;
+                    m_trimmed = false;
+                    return;
+                }
+                // Once per idle period: the next trim waits for activity and a new idle timeout.
+                if (m_trimmed || now - m_trim_last_activity < m_trim_idle_seconds)
+                    return;
+                m_trimmed = true;
+                if (trim(m_trim_max_slack) != 0)
+                    MemoryTrim::release_to_os();
+            }
+
+            void update_objects()
+            {
+                for (auto& object : m_objects)
+                {
+                    update_object(*object);
+                }
+            }
+
+        public:
+            Window(const std::string& name, bool open = true, ImGuiWindowFlags flags = 0)
+                : m_name(name), m_open(open), m_flags(flags)
+            {
+            }
+
+            ~Window() = default;
+
+            void update()
+            {
+                uint64_t begin = Trace::is_enabled() ? Trace::now() : 0;
+                Metrics::new_frame();
+                Scheduler::Scope scope(m_scheduler);
+                ImGui::Begin(m_name.c_str(), &m_open, m_flags);
+                // Widgets changed outside update(), or scheduled work that may have changed them
+                // since the last frame, invalidate the recording.
+                if (m_change_flag->consume() || m_jobs_active)
+                    m_dirty = true;
+                if (m_cached)
+                    m_cache.update(m_dirty, [this] { update_objects(); });
+                else
+                    update_objects();
+                if (m_trim_idle_seconds > 0.0)
+                    trim_if_idle();
+                ImGui::End();
+                bool jobs_active = !m_scheduler.is_idle();
+                m_scheduler.run(m_frame_budget);
+                m_jobs_active = jobs_active || !m_scheduler.is_idle();
+                if (begin != 0)
+                    Trace::record(begin, Trace::now(), typeid(Window), m_name);
+            }
+
+            const std::string& get_name() const
+            {
+                return m_name;
+            }
+
+            void report_memory(MemoryReport& report) const
+            {
+                report.begin(typeid(Window), m_name);
+                report.add(MemoryReport::bytes_of(m_name) + MemoryReport::bytes_of(m_objects) + m_cache.get_memory_bytes());
+                for (auto& object : m_objects)
+                {
+                    report.report(*object);
+                }
+                report.end();
+            }
+
+            size_t trim(float max_slack = 1.0f)
+            {
+                size_t released = MemoryTrim::shrink(m_objects, max_slack) + m_cache.trim(max_slack);
+                for (auto& object : m_objects)
+                {
+                    released += object->trim(max_slack);
+                }
+                return released;
+            }
+
+            // After idle_seconds without interaction, trims containers above max_slack times their
+            // size and returns freed pages to the OS, once per idle period. 0 disables it.
+            Window& set_trim_policy(double idle_seconds, float max_slack = 4.0f)
+            {
+                m_trim_idle_seconds = idle_seconds;
+                m_trim_max_slack = max_slack;
+                return *this;
+            }
+
+            Window& add_object(GuiObject object)
+            {
+                object->attach(m_change_flag);
+                m_objects.push_back(std::move(object));
+                m_dirty = true;
+                return *this;
+            }
+
+            Window& add_object(GuiObjectPtr object)
+            {
+                object->attach(m_change_flag);
+                m_objects.push_back(GuiObject(object));
+                m_dirty = true;
+                return *this;
+            }
+
+            // Records the window's draw commands and replays them while the window is not dirty
+            // and not interacted with. Content opening its own window (Child, Tree, scrolling
+            // Table) cannot be cached and keeps the window live. Widgets report data changes
+            // through Object::mark_changed(); data read through pointers the widget does not own
+            // needs mark_changed() or mark_dirty() from the caller.
+            Window& set_cached(bool cached)
+            {
+                m_cached = cached;
+                m_cache.invalidate();
+                return *this;
+            }
+
+            Window& mark_dirty()
+            {
+                m_dirty = true;
+                return *this;
+            }
+
+            Scheduler& get_scheduler()
+            {
+                return m_scheduler;
+            }
+
+            // Time in seconds given to scheduled UI-thread jobs at the end of every update().
+            Window& set_frame_budget(double frame_budget)
+            {
+                m_frame_budget = frame_budget;
+                return *this;
+            }
+        };
+
+        using GuiWindow = Ref<Window>;
+        using GuiWindowPtr = Window *;
+
+        class MenuItem : public Object
+        {
+        private:
+            std::string m_name;
+            std::string m_shortcut = "";
+            std::function<void()> m_callback = nullptr;
+
+        public:
+            MenuItem(const std::string& name, const std::string& shortcut, std::function<void()> callback)
+                : m_name(name), m_shortcut(shortcut), m_callback(callback)
+            {
+            }
+
+            virtual void update() override
+            {
+                if (ImGui::MenuItem(m_name.c_str(), m_shortcut.c_str()))
+                    m_callback();
+            }
+
+            bool is_valid() const
+            {
+                return !m_name.empty() && m_callback != nullptr;
+            }
+
+            MenuItem& set_name(const std::string& name)
+            {
+                m_name = name;
+                return *this;
+            }
+
+            MenuItem& set_shortcut(const std::string& shortcut)
+            {
+                m_shortcut = shortcut;
+                return *this;
+            }
+
+            MenuItem& set_callback(std::function<void()> callback)
+            {
+                m_callback = callback;
+                return *this;
+            }
+
+            virtual void report_memory(MemoryReport& report) const override
+            {
+                report.add(MemoryReport::bytes_of(m_name) + MemoryReport::bytes_of(m_shortcut)).add_callback(m_callback);
+            }
+
+            virtual const std::string& get_name() const override
+            {
+                return m_name;
+            }
+        };
+
+        using GuiMenuItem = Ref<MenuItem>;
+        using GuiMenuItemPtr = MenuItem *;
+
+        class Menu : public Object
+        {
+        private:
+            std::string m_name;
+            std::vector<GuiMenuItem> m_items;
+        
+        public:
+            Menu(const std::string& name)
+                : m_name(name)
+            {
+            }
+
+            virtual void update() override
+            {
+                if (ImGui::BeginMenu(m_name.c_str()))
+                {
+                    for (auto& item : m_items)
+                    {
+                        update_object(*item);
+                    }
+
+                    ImGui::EndMenu();
+                }
+            }
+
+            void add_item(GuiMenuItem item)
+            {
+                item->attach(get_change_flag());
+                m_items.push_back(std::move(item));
+            }
+
+            void add_item(GuiMenuItemPtr item)
+            {
+                item->attach(get_change_flag());
+                m_items.push_back(GuiMenuItem(item));
+            }
+
+            virtual void attach(const std::shared_ptr<ChangeFlag>& flag) override
+            {
+                Object::attach(flag);
+                for (auto& item : m_items)
+                {
+                    item->attach(flag);
+                }
+            }
+
+            virtual size_t trim(float max_slack) override
+            {
+                size_t released = MemoryTrim::shrink(m_items, max_slack);
+                for (auto& item : m_items)
+                {
+                    released += item->trim(max_slack);
+                }
+                return released;
+            }
+
+            virtual void report_memory(MemoryReport& report) const override
+            {
+                report.add(MemoryReport::bytes_of(m_name) + MemoryReport::bytes_of(m_items));
+                for (auto& item : m_items)
+                {
+                    report.report(*item);
+                }
+            }
+
+            virtual const std::string& get_name() const override
+            {
+                return m_name;
+            }
+        };
+
+        using GuiMenu = Ref<Menu>;
+        using GuiMenuPtr = Menu *;
+
+        class MenuBar : public Object
+        {
+        private:
+            std::vector<GuiMenu> m_menus;
+
+        public:
+            MenuBar() = default;
+            virtual ~MenuBar() = default;
+
+            virtual void update() override
+            {
+                if (ImGui::BeginMenuBar())
+                {
+                    for (auto& menu : m_menus)
+                    {
+                        update_object(*menu);
+                    }
+
+                    ImGui::EndMenuBar();
+                }
+            }
+
+            void add_menu(GuiMenu menu)
+            {
+                menu->attach(get_change_flag());
+                m_menus.push_back(std::move(menu));
+            }
+
+            void add_menu(GuiMenuPtr menu)
+            {
+                menu->attach(get_change_flag());
+                m_menus.push_back(GuiMenu(menu));
+            }
+
+            virtual void attach(const std::shared_ptr<ChangeFlag>& flag) override
+            {
+                Object::attach(flag);
+                for (auto& menu : m_menus)
+                {
+                    menu->attach(flag);
+                }
+            }
+
+            virtual size_t trim(float max_slack) override
+            {
+                size_t released = MemoryTrim::shrink(m_menus, max_slack);
+                for (auto& menu : m_menus)
+                {
+                    released += menu->trim(max_slack);
+                }
+                return released;
+            }
+
+            virtual void report_memory(MemoryReport& report) const override
+            {
+                report.add(MemoryReport::bytes_of(m_menus));
+                for (auto& menu : m_menus)
+                {
+                    report.report(*menu);
+                }
+            }
+        };
+
+        using GuiMenuBar = Ref<MenuBar>;
+        using GuiMenuBarPtr = MenuBar *;
+
+        class ColorEdit : public Object
+        {
+        private:
+            std::string m_name;
+            ImVec4 *m_color;
+            
+        
+        public:
+            ColorEdit(const std::string& name, ImVec4 *color)
+                : m_name(name), m_color(color)
+            {
+            }
+
+            virtual void update() override
+            {
+                ImGui::ColorEdit4(m_name.c_str(), &m_color->x);
+            }
+
+            ColorEdit& set_name(const std::string& name)
+            {
+                m_name = name;
+                return *this;
+            }
+
+            ColorEdit& set_color(ImVec4 *color)
+            {
+                m_color = color;
+                return *this;
+            }
+
+            virtual const std::string& get_name() const override
+            {
+                return m_name;
+            }
+        };
+
+        using GuiColorEdit = Ref<ColorEdit>;
+        using GuiColorEditPtr = ColorEdit *;
+
+        class Palette : public Object
+        {
+        private:
+            std::string m_name;
+            ImVec4 *m_colors;
+            size_t m_count;
+            float m_swatch_size = 16.0f;
+            float m_spacing = 2.0f;
+            size_t m_selected = SIZE_MAX;
+            size_t m_changed_first = SIZE_MAX;
+            size_t m_changed_last = 0;
+            ImGuiColorEditFlags m_picker_flags = ImGuiColorEditFlags_AlphaBar;
+            std::function<void(size_t first, size_t count)> m_on_change;
+
+            void mark_changed(size_t first, size_t count)
+            {
+                m_changed_first = std::min(m_changed_first, first);
+                m_changed_last = std::max(m_changed_last, first + count);
+            }
+
+        public:
+            // Edits count colors of colors in place; colors is not owned.
+            Palette(const std::string& name, ImVec4 *colors, size_t count)
+                : m_name(name), m_colors(colors), m_count(count)
+            {
+            }
+
+            // All swatches go to the window draw list in one loop over the visible rows and share
+            // a single hit-test item; only the selected entry gets a full ColorEdit4.
+            virtual void update() override
+            {
+                float cell = m_swatch_size + m_spacing;
+                int columns = std::max(1, (int)((ImGui::GetContentRegionAvail().x + m_spacing) / cell));
+                size_t rows = (m_count + columns - 1) / columns;
+                ImVec2 origin = ImGui::GetCursorScreenPos();
+                ImVec2 size(columns * cell - m_spacing, std::max(rows * cell - m_spacing, 1.0f));
+
+                ImGui::InvisibleButton(m_name.c_str(), size);
+                size_t hovered = SIZE_MAX;
+                if (ImGui::IsItemHovered())
+                {
+                    ImVec2 mouse = ImGui::GetMousePos();
+                    size_t column = (size_t)((mouse.x - origin.x) / cell);
+                    size_t row = (size_t)((mouse.y - origin.y) / cell);
+                    size_t index = row * columns + column;
+                    if (column < (size_t)columns && index < m_count)
+                        hovered = index;
+                }
+                if (hovered != SIZE_MAX && ImGui::IsItemClicked())
+                    m_selected = hovered;
+
+                ImDrawList *draw_list = ImGui::GetWindowDrawList();
+                float clip_top = draw_list->GetClipRectMin().y;
+                float clip_bottom = draw_list->GetClipRectMax().y;
+                size_t first_row = (size_t)std::max(0.0f, (clip_top - origin.y) / cell);
+                size_t last_row = std::min(rows, (size_t)std::max(0.0f, (clip_bottom - origin.y) / cell + 1));
+                ImU32 border = ImGui::GetColorU32(ImGuiCol_Border);
+                for (size_t row = first_row; row < last_row; row++)
+                {
+                    for (size_t column = 0; column < (size_t)columns; column++)
+                    {
+                        size_t index = row * columns + column;
+                        if (index >= m_count)
+                            break;
+                        ImVec2 min(origin.x + column * cell, origin.y + row * cell);
+                        ImVec2 max(min.x + m_swatch_size, min.y + m_swatch_size);
+                        draw_list->AddRectFilled(min, max, ImGui::ColorConvertFloat4ToU32(m_colors[index]));
+                        if (index == m_selected || index == hovered)
+                            draw_list->AddRect(min, max, index == m_selected ? IM_COL32_WHITE : border, 0.0f, 0, 2.0f);
+                    }
+                }
+
+                if (hovered != SIZE_MAX)
+                {
+                    const ImVec4& color = m_colors[hovered];
+                    ImGui::SetTooltip("%zu: %.3f, %.3f, %.3f, %.3f", hovered, color.x, color.y, color.z, color.w);
+                }
+
+                if (m_selected < m_count)
+                {
+                    ImGui::PushID(m_name.c_str());
+                    if (ImGui::ColorEdit4("##selected", &m_colors[m_selected].x, m_picker_flags))
+                        mark_changed(m_selected, 1);
+                    ImGui::PopID();
+                }
+
+                if (m_on_change && m_changed_first < m_changed_last)
+                {
+                    m_on_change(m_changed_first, m_changed_last - m_changed_first);
+                    m_changed_first = SIZE_MAX;
+                    m_changed_last = 0;
+                }
+            }
+
+            Palette& set_name(const std::string& name)
+            {
+                m_name = name;
+                return *this;
+            }
+
+            Palette& set_colors(ImVec4 *colors, size_t count)
+            {
+                m_colors = colors;
+                m_count = count;
+                m_selected = SIZE_MAX;
+                mark_changed(0, count);
+                return *this;
+            }
+
+            // Writes through the palette so the change is reported to consumers.
+            Palette& set_color(size_t index, const ImVec4& color)
+            {
+                m_colors[index] = color;
+                mark_changed(index, 1);
+                return *this;
+            }
+
+            Palette& set_swatch_size(float swatch_size, float spacing = 2.0f)
+            {
+                m_swatch_size = swatch_size;
+                m_spacing = spacing;
+                return *this;
+            }
+
+            Palette& set_picker_flags(ImGuiColorEditFlags picker_flags)
+            {
+                m_picker_flags = picker_flags;
+                return *this;
+            }
+
+            Palette& set_selected(size_t selected)
+            {
+                m_selected = selected;
+                return *this;
+            }
+
+            // Called once per frame with the smallest range covering every change since the last call.
+            Palette& set_on_change(const std::function<void(size_t first, size_t count)>& on_change)
+            {
+                m_on_change = on_change;
+                return *this;
+            }
+
+            // Polling alternative to set_on_change: returns false when nothing changed.
+            bool consume_changes(size_t& first, size_t& count)
+            {
+                if (m_changed_first >= m_changed_last)
+                    return false;
+                first = m_changed_first;
+                count = m_changed_last - m_changed_first;
+                m_changed_first = SIZE_MAX;
+                m_changed_last = 0;
+                return true;
+            }
+
+            size_t get_selected() const
+            {
+                return m_selected;
+            }
+
+            virtual void report_memory(MemoryReport& report) const override
+            {
+                report.add(MemoryReport::bytes_of(m_name)).add_callback(m_on_change);
+            }
+
+            virtual const std::string& get_name() const override
+            {
+                return m_name;
+            }
+        };
+
+        using GuiPalette = Ref<Palette>;
+        using GuiPalettePtr = Palette *;
+
+        class PlotLines : public Object
+        {
+        private:
+            std::string m_name;
+            std::vector<float> m_values;
+            int m_values_offset = 0;
+            std::string m_overlay_text = "";
+            float m_scale_min = FLT_MAX;
+            float m_scale_max = FLT_MAX;
+            ImVec2 m_graph_size = ImVec2(0, 0);
+            int m_stride = sizeof(float);
+        
+        public:
+            PlotLines(const std::string& name, const std::vector<float>& values)
+                : m_name(name), m_values(values)
+            {
+            }
+
+            virtual void update() override
+            {
+                ImGui::PlotLines(m_name.c_str(), &m_values[0], m_values.size(), m_values_offset, m_overlay_text.c_str(), m_scale_min, m_scale_max, m_graph_size, m_stride);
+            }
+
+            // Streams a sample into the plot, overwriting the oldest one.
+            PlotLines& push_value(float value)
+            {
+                if (m_values.empty())
+                    return *this;
+                m_values[m_values_offset] = value;
+                m_values_offset = (m_values_offset + 1) % (int)m_values.size();
+                mark_changed();
+                return *this;
+            }
+
+            PlotLines& set_values_offset(int values_offset)
+            {
+                m_values_offset = values_offset;
+                mark_changed();
+                return *this;
+            }
+
+            PlotLines& set_overlay_text(const std::string& overlay_text)
+            {
+                m_overlay_text = overlay_text;
+                return *this;
+            }
+
+            PlotLines& set_scale_min(float scale_min)
+            {
+                m_scale_min = scale_min;
+                return *this;
+            }
+
+            PlotLines& set_scale_max(float scale_max)
+            {
+                m_scale_max = scale_max;
+                return *this;
+            }
+
+            PlotLines& set_graph_size(const ImVec2& graph_size)
+            {
+                m_graph_size = graph_size;
+                return *this;
+            }
+
+            PlotLines& set_stride(int stride)
+            {
+                m_stride = stride;
+                return *this;
+            }
+
+            virtual size_t trim(float max_slack) override
+            {
+                return MemoryTrim::shrink(m_values, max_slack) + MemoryTrim::shrink(m_overlay_text, max_slack);
+            }
+
+            virtual void report_memory(MemoryReport& report) const override
+            {
+                report.add(MemoryReport::bytes_of(m_name) + MemoryReport::bytes_of(m_values) + MemoryReport::bytes_of(m_overlay_text));
+            }
+
+            virtual const std::string& get_name() const override
+            {
+                return m_name;
+            }
+        };
+
+        using GuiPlotLines = Ref<PlotLines>;
+        using GuiPlotLinesPtr = PlotLines *;
+
+        class Histogram : public Object
+        {
+        private:
+            std::string m_name;
+            std::vector<float> m_values;
+            int m_values_offset = 0;
+            std::string m_overlay_text = "";
+            float m_scale_min = FLT_MAX;
+            float m_scale_max = FLT_MAX;
+            ImVec2 m_graph_size = ImVec2(0, 0);
+            int m_stride = sizeof(float);
+
+        public:
+
+            Histogram(const std::string& name, const std::vector<float>& values)
+                : m_name(name), m_values(values)
+            {
+            }
+
+            virtual void update() override
+            {
+                ImGui::PlotHistogram(m_name.c_str(), &m_values[0], m_values.size(), m_values_offset, m_overlay_text.c_str(), m_scale_min, m_scale_max, m_graph_size, m_stride);
+            }
 
             Histogram& set_values_offset(int values_offset)
             {
-                m_values_offset = values_offset;
-                return *this;
+                m_values_offset = values_offset;
+                return *this;
+            }
+
+            Histogram& set_overlay_text(const std::string& overlay_text)
+            {
+                m_overlay_text = overlay_text;
+                return *this;
+            }
+
+            Histogram& set_scale_min(float scale_min)
+            {
+                m_scale_min = scale_min;
+                return *this;
+            }
+
+            Histogram& set_scale_max(float scale_max)
+            {
+                m_scale_max = scale_max;
+                return *this;
+            }
+
+            Histogram& set_graph_size(const ImVec2& graph_size)
+            {
+                m_graph_size = graph_size;
+                return *this;
+            }
+
+            Histogram& set_stride(int stride)
+            {
+                m_stride = stride;
+                return *this;
+            }
+
+            virtual size_t trim(float max_slack) override
+            {
+                return MemoryTrim::shrink(m_values, max_slack) + MemoryTrim::shrink(m_overlay_text, max_slack);
+            }
+
+            virtual void report_memory(MemoryReport& report) const override
+            {
+                report.add(MemoryReport::bytes_of(m_name) + MemoryReport::bytes_of(m_values) + MemoryReport::bytes_of(m_overlay_text));
+            }
+
+            virtual const std::string& get_name() const override
+            {
+                return m_name;
+            }
+        };
+
+        class Text : public Object
+        {
+        private:
+            std::string *m_text;
+            float rgba[4];
+            float m_wrap_width = 0.0f;
+
+            std::vector<std::pair<uint32_t, uint32_t>> m_wrap_lines;
+            std::string m_wrap_text;
+            float m_wrap_cached_width = -1.0f;
+            float m_wrap_font_size = -1.0f;
+            bool m_wrap_dirty = true;
+
+            // The text is owned by the caller and may change in place, so the copy it was wrapped
+            // from is compared (one memcmp) instead of hashing the string every frame.
+            void layout_wrap(float width)
+            {
+                ImFont *font = ImGui::GetFont();
+                float font_size = ImGui::GetFontSize();
+                if (!m_wrap_dirty && width == m_wrap_cached_width && font_size == m_wrap_font_size && *m_text == m_wrap_text)
+                    return;
+
+                m_wrap_dirty = false;
+                m_wrap_text = *m_text;
+                m_wrap_cached_width = width;
+                m_wrap_font_size = font_size;
+                m_wrap_lines.clear();
+
+                const char *begin = m_text->data();
+                const char *end = begin + m_text->size();
+                float scale = font_size / font->FontSize;
+                for (const char *paragraph = begin; paragraph <= end;)
+                {
+                    const char *paragraph_end = (const char *)memchr(paragraph, '\n', end - paragraph);
+                    if (paragraph_end == nullptr)
+                        paragraph_end = end;
+
+                    const char *line = paragraph;
+                    do
+                    {
+                        const char *line_end = font->CalcWordWrapPositionA(scale, line, paragraph_end, width);
+                        if (line_end == line && line < paragraph_end)
+                            line_end++;
+                        m_wrap_lines.emplace_back((uint32_t)(line - begin), (uint32_t)(line_end - begin));
+                        line = line_end;
+                        while (line < paragraph_end && (*line == ' ' || *line == '\t'))
+                        {
+                            line++;
+                        }
+                    } while (line < paragraph_end);
+                    paragraph = paragraph_end + 1;
+                }
+            }
+
+        public:
+            Text(std::string *text, float r, float g, float b, float a)
+                : m_text(text)
+            {
+                set_color(r, g, b, a);
+            }
+
+            virtual void update() override
+            {
+                ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(rgba[0], rgba[1], rgba[2], rgba[3]));
+                float width = m_wrap_width < 0.0f ? ImGui::GetContentRegionAvail().x : m_wrap_width;
+                if (width <= 0.0f)
+                {
+                    ImGui::TextUnformatted(m_text->data(), m_text->data() + m_text->size());
+                    ImGui::PopStyleColor();
+                    return;
+                }
+
+                layout_wrap(width);
+                const char *text = m_text->data();
+                ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(ImGui::GetStyle().ItemSpacing.x, 0.0f));
+                ImGuiListClipper clipper;
+                clipper.Begin((int)m_wrap_lines.size(), ImGui::GetTextLineHeight());
+                while (clipper.Step())
+                {
+                    for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
+                    {
+                        ImGui::TextUnformatted(text + m_wrap_lines[i].first, text + m_wrap_lines[i].second);
+                    }
+                }
+                ImGui::PopStyleVar();
+                ImGui::PopStyleColor();
+            }
+
+            Text& set_text(std::string* text)
+            {
+                m_text = text;
+                m_wrap_dirty = true;
+                mark_changed();
+                return *this;
+            }
+
+            // Forces a re-wrap on the next frame, e.g. after changing fonts.
+            Text& invalidate()
+            {
+                m_wrap_dirty = true;
+                return *this;
+            }
+
+            Text& set_color(float r, float g, float b, float a)
+            {
+                rgba[0] = r;
+                rgba[1] = g;
+                rgba[2] = b;
+                rgba[3] = a;
+                return *this;
+            }
+
+            float *get_color()
+            {
+                return rgba;
+            }
+
+            // 0 disables wrapping, a negative width wraps at the right edge of the content region.
+            Text& set_wrap_width(float wrap_width)
+            {
+                m_wrap_width = wrap_width;
+                return *this;
+            }
+
+            float get_wrap_width() const
+            {
+                return m_wrap_width;
+            }
+
+            virtual size_t trim(float max_slack) override
+            {
+                return MemoryTrim::shrink(m_wrap_lines, max_slack) + MemoryTrim::shrink(m_wrap_text, max_slack);
+            }
+
+            virtual void report_memory(MemoryReport& report) const override
+            {
+                report.add(MemoryReport::bytes_of(m_wrap_lines) + MemoryReport::bytes_of(m_wrap_text));
+            }
+        };
+
+        using GuiText = Ref<Text>;
+        using GuiTextPtr = Text *;
+
+        enum TextStyle : uint8_t
+        {
+            TextStyle_None = 0,
+            TextStyle_Bold = 1 << 0,
+            TextStyle_Underline = 1 << 1,
+            TextStyle_Strikethrough = 1 << 2,
+        };
+
+        struct TextSpan
+        {
+            uint32_t offset;
+            uint32_t length;
+            ImU32 color;
+            uint8_t style;
+        };
+
+        class RichText : public Object
+        {
+        private:
+            std::string m_text;
+            std::vector<TextSpan> m_spans;
+            ImU32 m_color = 0;
+            float m_width = 0.0f;
+
+            static float draw_segment(ImDrawList *draw_list, ImFont *font, float font_size, ImVec2 pos, const char *begin, const char *end, ImU32 color, uint8_t style)
+            {
+                float width = font->CalcTextSizeA(font_size, FLT_MAX, 0.0f, begin, end).x;
+                draw_list->AddText(font, font_size, pos, color, begin, end);
+                if (style & TextStyle_Bold)
+                    draw_list->AddText(font, font_size, ImVec2(pos.x + 1.0f, pos.y), color, begin, end);
+                if (style & TextStyle_Underline)
+                    draw_list->AddLine(ImVec2(pos.x, pos.y + font_size), ImVec2(pos.x + width, pos.y + font_size), color);
+                if (style & TextStyle_Strikethrough)
+                    draw_list->AddLine(ImVec2(pos.x, pos.y + font_size * 0.5f), ImVec2(pos.x + width, pos.y + font_size * 0.5f), color);
+                return width;
+            }
+
+        public:
+            RichText() = default;
+
+            RichText(const std::string& text, ImU32 color = 0)
+                : m_text(text), m_color(color)
+            {
+            }
+
+            // Draws a single line in one pass; spans must be sorted by offset and must not overlap.
+            // Bytes not covered by a span, and spans with a color of 0, use default_color. Returns the drawn width.
+            static float draw(ImDrawList *draw_list, ImVec2 pos, const char *text, size_t size, const TextSpan *spans, size_t span_count, ImU32 default_color)
+            {
+                ImFont *font = ImGui::GetFont();
+                float font_size = ImGui::GetFontSize();
+                float x = pos.x;
+                size_t cursor = 0;
+                for (size_t i = 0; i < span_count; i++)
+                {
+                    const TextSpan& span = spans[i];
+                    size_t span_begin = std::min<size_t>(span.offset, size);
+                    size_t span_end = std::min<size_t>(span_begin + span.length, size);
+                    if (span_begin > cursor)
+                        x += draw_segment(draw_list, font, font_size, ImVec2(x, pos.y), text + cursor, text + span_begin, default_color, TextStyle_None);
+                    if (span_end > span_begin)
+                        x += draw_segment(draw_list, font, font_size, ImVec2(x, pos.y), text + span_begin, text + span_end, span.color != 0 ? span.color : default_color, span.style);
+                    cursor = std::max(cursor, span_end);
+                }
+                if (cursor < size)
+                    x += draw_segment(draw_list, font, font_size, ImVec2(x, pos.y), text + cursor, text + size, default_color, TextStyle_None);
+                return x - pos.x;
+            }
+
+            virtual void update() override
+            {
+                ImVec2 pos = ImGui::GetCursorScreenPos();
+                float height = ImGui::GetTextLineHeight();
+                if (ImGui::IsRectVisible(pos, ImVec2(pos.x + std::max(m_width, 1.0f), pos.y + height)))
+                {
+                    ImU32 color = m_color != 0 ? m_color : ImGui::GetColorU32(ImGuiCol_Text);
+                    m_width = draw(ImGui::GetWindowDrawList(), pos, m_text.data(), m_text.size(), m_spans.data(), m_spans.size(), color);
+                }
+                ImGui::Dummy(ImVec2(m_width, height));
+            }
+
+            RichText& set_text(const std::string& text)
+            {
+                m_text = text;
+                m_spans.clear();
+                m_width = 0.0f;
+                mark_changed();
+                return *this;
+            }
+
+            RichText& set_text(std::string&& text, std::vector<TextSpan>&& spans)
+            {
+                m_text = std::move(text);
+                m_spans = std::move(spans);
+                m_width = 0.0f;
+                mark_changed();
+                return *this;
+            }
+
+            RichText& append(const char *text, size_t size, ImU32 color, uint8_t style = TextStyle_None)
+            {
+                m_spans.push_back({(uint32_t)m_text.size(), (uint32_t)size, color, style});
+                m_text.append(text, size);
+                m_width = 0.0f;
+                mark_changed();
+                return *this;
+            }
+
+            RichText& append(const std::string& text, ImU32 color, uint8_t style = TextStyle_None)
+            {
+                return append(text.data(), text.size(), color, style);
+            }
+
+            RichText& add_span(uint32_t offset, uint32_t length, ImU32 color, uint8_t style = TextStyle_None)
+            {
+                m_spans.push_back({offset, length, color, style});
+                mark_changed();
+                return *this;
+            }
+
+            RichText& clear()
+            {
+                m_text.clear();
+                m_spans.clear();
+                m_width = 0.0f;
+                mark_changed();
+                return *this;
+            }
+
+            // 0 uses the current ImGuiCol_Text.
+            RichText& set_color(ImU32 color)
+            {
+                m_color = color;
+                return *this;
+            }
+
+            const std::string& get_text() const
+            {
+                return m_text;
+            }
+
+            const std::vector<TextSpan>& get_spans() const
+            {
+                return m_spans;
+            }
+
+            virtual size_t trim(float max_slack) override
+            {
+                return MemoryTrim::shrink(m_text, max_slack) + MemoryTrim::shrink(m_spans, max_slack);
+            }
+
+            virtual void report_memory(MemoryReport& report) const override
+            {
+                report.add(MemoryReport::bytes_of(m_text) + MemoryReport::bytes_of(m_spans));
+            }
+        };
+
+        using GuiRichText = Ref<RichText>;
+        using GuiRichTextPtr = RichText *;
+
+        class AnsiParser
+        {
+        private:
+            ImU32 m_color = 0;
+            uint8_t m_style = TextStyle_None;
+
+            static ImU32 palette_color(int index)
+            {
+                static const ImU32 palette[16] = {
+                    IM_COL32(0, 0, 0, 255), IM_COL32(205, 49, 49, 255), IM_COL32(13, 188, 121, 255), IM_COL32(229, 229, 16, 255),
+                    IM_COL32(36, 114, 200, 255), IM_COL32(188, 63, 188, 255), IM_COL32(17, 168, 205, 255), IM_COL32(229, 229, 229, 255),
+                    IM_COL32(102, 102, 102, 255), IM_COL32(241, 76, 76, 255), IM_COL32(35, 209, 139, 255), IM_COL32(245, 245, 67, 255),
+                    IM_COL32(59, 142, 234, 255), IM_COL32(214, 112, 214, 255), IM_COL32(41, 184, 219, 255), IM_COL32(255, 255, 255, 255),
+                };
+                static const int levels[6] = {0, 95, 135, 175, 215, 255};
+
+                if (index < 16)
+                    return palette[index];
+                if (index < 232)
+                {
+                    index -= 16;
+                    return IM_COL32(levels[index / 36], levels[(index / 6) % 6], levels[index % 6], 255);
+                }
+                int gray = 8 + 10 * (index - 232);
+                return IM_COL32(gray, gray, gray, 255);
+            }
+
+            void apply_sgr(const int *params, size_t count)
+            {
+                if (count == 0)
+                {
+                    reset();
+                    return;
+                }
+                for (size_t i = 0; i < count; i++)
+                {
+                    int code = params[i];
+                    if (code == 0)
+                        reset();
+                    else if (code == 1)
+                        m_style |= TextStyle_Bold;
+                    else if (code == 4)
+                        m_style |= TextStyle_Underline;
+                    else if (code == 9)
+                        m_style |= TextStyle_Strikethrough;
+                    else if (code == 21 || code == 22)
+                        m_style &= ~TextStyle_Bold;
+                    else if (code == 24)
+                        m_style &= ~TextStyle_Underline;
+                    else if (code == 29)
+                        m_style &= ~TextStyle_Strikethrough;
+                    else if (code >= 30 && code <= 37)
+                        m_color = palette_color(code - 30);
+                    else if (code >= 90 && code <= 97)
+                        m_color = palette_color(code - 90 + 8);
+                    else if (code == 39)
+                        m_color = 0;
+                    else if (code == 38 || code == 48)
+                    {
+                        ImU32 color = 0;
+                        if (i + 2 < count && params[i + 1] == 5)
+                        {
+                            color = palette_color(std::min(std::max(params[i + 2], 0), 255));
+                            i += 2;
+                        }
+                        else if (i + 4 < count && params[i + 1] == 2)
+                        {
+                            color = IM_COL32(params[i + 2] & 0xFF, params[i + 3] & 0xFF, params[i + 4] & 0xFF, 255);
+                            i += 4;
+                        }
+                        else
+                        {
+                            break;
+                        }
+                        if (code == 38)
+                            m_color = color;
+                    }
+                }
+            }
+
+        public:
+            void reset()
+            {
+                m_color = 0;
+                m_style = TextStyle_None;
+            }
+
+            bool is_default() const
+            {
+                return m_color == 0 && m_style == TextStyle_None;
+            }
+
+            // Appends text without escape sequences to out and records a span for every run that is
+            // not in the default state. A span color of 0 means the renderer's default color.
+            // The SGR state carries over between calls, like a terminal.
+            void parse(const char *text, size_t size, std::string& out, std::vector<TextSpan>& spans)
+            {
+                size_t run_begin = out.size();
+                auto flush = [&] {
+                    if (out.size() > run_begin && !is_default())
+                        spans.push_back({(uint32_t)run_begin, (uint32_t)(out.size() - run_begin), m_color, m_style});
+                    run_begin = out.size();
+                };
+
+                size_t i = 0;
+                while (i < size)
+                {
+                    const char *escape = (const char *)memchr(text + i, '\x1b', size - i);
+                    size_t plain_end = escape ? escape - text : size;
+                    out.append(text + i, plain_end - i);
+                    i = plain_end;
+                    if (i >= size)
+                        break;
+
+                    i++;
+                    if (i < size && text[i] == '[')
+                    {
+                        int params[16];
+                        size_t count = 0;
+                        int value = 0;
+                        bool has_value = false;
+                        for (i++; i < size; i++)
+                        {
+                            unsigned char c = text[i];
+                            if (c >= '0' && c <= '9')
+                            {
+                                value = std::min(value * 10 + (c - '0'), 0xFFFF);
+                                has_value = true;
+                            }
+                            else if (c == ';' || c == ':')
+                            {
+                                if (count < 16)
+                                    params[count++] = value;
+                                value = 0;
+                                has_value = false;
+                            }
+                            else if (c >= 0x40 && c <= 0x7E)
+                            {
+                                if (has_value && count < 16)
+                                    params[count++] = value;
+                                if (c == 'm')
+                                {
+                                    flush();
+                                    apply_sgr(params, count);
+                                }
+                                i++;
+                                break;
+                            }
+                        }
+                    }
+                    else if (i < size && text[i] == ']')
+                    {
+                        for (i++; i < size; i++)
+                        {
+                            if (text[i] == '\a')
+                            {
+                                i++;
+                                break;
+                            }
+                            if (text[i] == '\x1b' && i + 1 < size && text[i + 1] == '\\')
+                            {
+                                i += 2;
+                                break;
+                            }
+                        }
+                    }
+                    else if (i < size)
+                    {
+                        i++;
+                    }
+                }
+                flush();
+            }
+        };
+
+        class Logger : public Object
+        {
+        private:
+            struct Line
+            {
+                std::string text;
+                std::vector<TextSpan> spans;
+            };
+
+            size_t m_max_lines = 0;
+            std::deque<Line> m_lines;
+            float rgba[4];
+            AnsiParser m_ansi;
+            bool m_parse_ansi = true;
+
+            void push_line(const char *text, size_t size)
+            {
+                if (size != 0 && text[size - 1] == '\r')
+                    size--;
+
+                Line line;
+                if (!m_parse_ansi || (m_ansi.is_default() && memchr(text, '\x1b', size) == nullptr))
+                    line.text.assign(text, size);
+                else
+                    m_ansi.parse(text, size, line.text, line.spans);
+                m_lines.push_back(std::move(line));
+                while (m_max_lines != 0 && m_lines.size() > m_max_lines)
+                {
+                    m_lines.pop_front();
+                }
+            }
+
+        public:
+            Logger(float r, float g, float b, float a)
+            {
+                set_color(r, g, b, a);
+            }
+
+            Logger& set_color(float r, float g, float b, float a)
+            {
+                rgba[0] = r;
+                rgba[1] = g;
+                rgba[2] = b;
+                rgba[3] = a;
+                return *this;
+            }
+
+            Logger& set_max_lines(size_t max_lines)
+            {
+                m_max_lines = max_lines;
+                return *this;
+            }
+
+            Logger& set_parse_ansi(bool parse_ansi)
+            {
+                m_parse_ansi = parse_ansi;
+                m_ansi.reset();
+                return *this;
+            }
+
+            // Every '\n' starts a new line; a trailing newline does not add an empty one.
+            Logger& add_text(const std::string& text)
+            {
+                const char *begin = text.data();
+                const char *end = begin + text.size();
+                uint64_t lines = 0;
+                do
+                {
+                    const char *line_end = (const char *)memchr(begin, '\n', end - begin);
+                    if (line_end == nullptr)
+                        line_end = end;
+                    push_line(begin, line_end - begin);
+                    begin = line_end + 1;
+                    lines++;
+                } while (begin < end);
+                Metrics::note_log_ingest(lines, text.size());
+                mark_changed();
+                return *this;
+            }
+
+            Logger& clear()
+            {
+                m_lines.clear();
+                m_ansi.reset();
+                mark_changed();
+                return *this;
+            }
+
+            size_t get_line_count() const
+            {
+                return m_lines.size();
+            }
+
+            const std::string& get_line(size_t index) const
+            {
+                return m_lines[index].text;
+            }
+
+            virtual void update() override
+            {
+                ImU32 color = ImGui::ColorConvertFloat4ToU32(ImVec4(rgba[0], rgba[1], rgba[2], rgba[3]));
+                float line_height = ImGui::GetTextLineHeight();
+
+                ImGui::PushStyleColor(ImGuiCol_Text, color);
+                ImGuiListClipper clipper;
+                clipper.Begin((int)m_lines.size());
+                while (clipper.Step())
+                {
+                    for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
+                    {
+                        const Line& line = m_lines[i];
+                        if (line.spans.empty())
+                        {
+                            ImGui::TextUnformatted(line.text.data(), line.text.data() + line.text.size());
+                            continue;
+                        }
+                        ImVec2 pos = ImGui::GetCursorScreenPos();
+                        float width = RichText::draw(ImGui::GetWindowDrawList(), pos, line.text.data(), line.text.size(), line.spans.data(), line.spans.size(), color);
+                        ImGui::Dummy(ImVec2(width, line_height));
+                    }
+                }
+                ImGui::PopStyleColor();
+            }
+
+            virtual size_t trim(float max_slack) override
+            {
+                return MemoryTrim::shrink(m_lines, max_slack);
+            }
+
+            virtual void report_memory(MemoryReport& report) const override
+            {
+                size_t bytes = MemoryReport::bytes_of(m_lines);
+                for (const Line& line : m_lines)
+                {
+                    bytes += MemoryReport::bytes_of(line.text) + MemoryReport::bytes_of(line.spans);
+                }
+                report.add(bytes);
+            }
+        };
+        
+        using GuiLogger = Ref<Logger>;
+        using GuiLoggerPtr = Logger *;
+
+        class Button : public Object
+        {
+        private:
+            std::string m_name;
+            std::function<void()> m_callback;
+
+        public:
+            Button(const std::string& name, const std::function<void()>& callback)
+                : m_name(name), m_callback(callback)
+            {
+            }
+
+            virtual void update() override
+            {
+                if (ImGui::Button(m_name.c_str()))
+                {
+                    m_callback();
+                }
+            }
+
+            Button& set_name(const std::string& name)
+            {
+                m_name = name;
+                return *this;
+            }
+
+            Button& set_callback(const std::function<void()>& callback)
+            {
+                m_callback = callback;
+                return *this;
+            }
+
+            Button& set_callback(std::function<void()>&& callback)
+            {
+                m_callback = std::move(callback);
+                return *this;
+            }
+
+            virtual void report_memory(MemoryReport& report) const override
+            {
+                report.add(MemoryReport::bytes_of(m_name)).add_callback(m_callback);
+            }
+
+            virtual const std::string& get_name() const override
+            {
+                return m_name;
+            }
+        };
+
+        using GuiButton = Ref<Button>;
+        using GuiButtonPtr = Button *;
+
+        template <typename T>
+        class SliderT : public Object
+        {
+        private:
+            std::string m_name;
+            T *m_value;
+            T m_min;
+            T m_max;
+            std::string m_format;
+            T m_power = 1.0f;
+        
+        public:
+            SliderT(const std::string& name, T *value, T min, T max)
+                : m_name(name), m_value(value), m_min(min), m_max(max)
+            {
+                if constexpr(std::is_same_v<T, float>)
+                {
+                    m_format = "%.3f";
+                }
+                else
+                {
+                    m_format = "%d";
+                }
+            }
+
+            virtual void update() override
+            {
+                if constexpr(std::is_same_v<T, float>)
+                {
+                    ImGui::SliderFloat(m_name.c_str(), m_value, m_min, m_max, m_format.c_str(), m_power);
+                }
+                else
+                {
+                    ImGui::SliderInt(m_name.c_str(), m_value, m_min, m_max, m_format.c_str(), m_power);
+                }
+            }
+
+            SliderT& set_name(const std::string& name)
+            {
+                m_name = name;
+                return *this;
+            }
+
+            SliderT& set_value(const std::vector<T>& value)
+            {
+                m_value = value;
+                return *this;
+            }
+
+            SliderT& set_min(T min)
+            {
+                m_min = min;
+                return *this;
+            }
+
+            SliderT& set_max(SliderT max)
+            {
+                m_max = max;
+                return *this;
+            }
+
+            SliderT& set_format(const std::string& format)
+            {
+                m_format = format;
+                return *this;
+            }
+
+            SliderT& set_power(T power)
+            {
+                m_power = power;
+                return *this;
+            }
+
+            virtual void report_memory(MemoryReport& report) const override
+            {
+                report.add(MemoryReport::bytes_of(m_name) + MemoryReport::bytes_of(m_format));
+            }
+
+            virtual const std::string& get_name() const override
+            {
+                return m_name;
+            }
+        };
+
+        using SliderFloat = SliderT<float>;
+        using SliderInt = SliderT<int>;
+
+        using GuiSliderFloat = Ref<SliderFloat>;
+        using GuiSliderFloatPtr = SliderFloat *;
+
+        using GuiSliderInt = Ref<SliderInt>;
+        using GuiSliderIntPtr = SliderInt *;
+
+        class InputText : public Object
+        {
+        private:
+            std::string m_name;
+            size_t m_max_length = 0;
+            char *m_text = nullptr;
+            ImGuiInputTextFlags m_flags = 0;
+
+        public:
+            InputText(const std::string& name, size_t max_length, const std::string& default_value = "")
+                : m_name(name), m_max_length(max_length), m_text(new char[max_length + 1])
+            {
+                set_value(default_value);
+            }
+
+            virtual void update() override
+            {
+                ImGui::InputText(m_name.c_str(), m_text, m_max_length);
+            }
+
+            InputText& set_name(const std::string& name)
+            {
+                m_name = name;
+                return *this;
+            }
+
+            InputText& set_value(const std::string& value)
+            {
+                size_t max_copy = std::min(value.size(), m_max_length);
+                memcpy(m_text, value.c_str(), max_copy);
+                m_text[max_copy] = '\0';
+                return *this;
+            }
+
+            InputText& set_max_length(size_t max_length)
+            {
+                m_max_length = max_length;
+                return *this;
+            }
+
+            InputText& set_flags(ImGuiInputTextFlags flags)
+            {
+                m_flags = flags;
+                return *this;
+            }
+
+            ~InputText()
+            {
+                delete[] m_text;
+            }
+
+            const char *get_ctext() const
+            {
+                return m_text;
+            }
+
+            std::string get_text() const
+            {
+                return std::string(m_text, m_max_length);
+            }
+
+            virtual void report_memory(MemoryReport& report) const override
+            {
+                report.add(MemoryReport::bytes_of(m_name) + m_max_length + 1);
+            }
+
+            virtual const std::string& get_name() const override
+            {
+                return m_name;
+            }
+        };
+
+        using GuiInputText = Ref<InputText>;
+        using GuiInputTextPtr = InputText *;
+
+        class Checkbox : public Object
+        {
+        private:
+            std::string m_name;
+            bool m_value = false;
+
+        public:
+            Checkbox(const std::string& name, bool value = false)
+                : m_name(name), m_value(value)
+            {
+            }
+
+            virtual void update() override
+            {
+                ImGui::Checkbox(m_name.c_str(), &m_value);
+            }
+
+            Checkbox& set_name(const std::string& name)
+            {
+                m_name = name;
+                return *this;
+            }
+
+            Checkbox& set_value(bool value)
+            {
+                m_value = value;
+                return *this;
+            }
+
+            bool get_value() const
+            {
+                return m_value;
+            }
+
+            virtual const std::string& get_name() const override
+            {
+                return m_name;
+            }
+        };
+
+        using GuiCheckbox = Ref<Checkbox>;
+        using GuiCheckboxPtr = Checkbox *;
+
+        class Combo : public Object
+        {
+        private:
+            std::string m_name;
+            int m_current_item = 0;
+            std::vector<char *> m_items;
+
+        public:
+            Combo(const std::string& name, int current_item = 0)
+                : m_name(name), m_current_item(current_item)
+            {
+            }
+
+            virtual void update() override
+            {
+                ImGui::Combo(m_name.c_str(), &m_current_item, m_items.data(), m_items.size());
+            }
+
+            Combo& set_name(const std::string& name)
+            {
+                m_name = name;
+                return *this;
+            }
+
+            void clear()
+            {
+                for (auto& item : m_items)
+                {
+                    delete[] item;
+                }
+                m_items.clear();
+            }
+
+            Combo& add_items(const std::vector<std::string>& items)
+            {
+                clear();
+                for (auto& item : items)
+                {
+                    add_item(item);
+                }
+                m_current_item = 0;
+                return *this;
+            }
+
+            Combo& add_item(const std::string& item)
+            {
+                char* cstr = new char[item.size() + 1];
+                memcpy(cstr, item.c_str(), item.size());
+                cstr[item.size()] = '\0';
+
+                m_items.push_back(cstr);
+                return *this;
+            }
+
+            Combo& set_current_item_index(int current_item)
+            {
+                m_current_item = current_item;
+                return *this;
+            }
+
+            int get_current_item_index() const
+            {
+                return m_current_item;
+            }
+
+            const char *get_current_item() const
+            {
+                if ((unsigned int)m_current_item >= m_items.size()) {
+                    return nullptr;
+                }
+                return m_items[m_current_item];
+            }
+
+            const std::vector<char *>& get_items() const
+            {
+                return m_items;
+            }
+
+            ~Combo()
+            {
+                clear();
+            }
+
+            virtual size_t trim(float max_slack) override
+            {
+                return MemoryTrim::shrink(m_items, max_slack);
+            }
+
+            virtual void report_memory(MemoryReport& report) const override
+            {
+                size_t bytes = MemoryReport::bytes_of(m_name) + MemoryReport::bytes_of(m_items);
+                for (const char *item : m_items)
+                {
+                    bytes += strlen(item) + 1;
+                }
+                report.add(bytes);
+            }
+
+            virtual const std::string& get_name() const override
+            {
+                return m_name;
+            }
+        };
+        
+        using GuiCombo = Ref<Combo>;
+        using GuiComboPtr = Combo *;
+        
+        class FuzzyCombo : public Object
+        {
+        private:
+            std::string m_name;
+            InputText m_input_text;
+            std::vector<std::string> m_items;
+            Combo m_filtered_combo;
+            std::string m_query;
+            bool m_items_dirty = true;
+            size_t m_scan_index = 0;
+            std::vector<std::pair<size_t, float>> m_matches;
+            JobHandle m_job;
+            uint64_t m_filter_begin = 0;
+
+            static constexpr size_t FILTER_SLICE = 2048;
+
+            float score(const std::string& item) const
+            {
+                static const float SCORE_EQUAL = 10;
+                static const float SCORE_NOT_SAME = -15;
+
+                float score = 0;
+                float max_score = SCORE_EQUAL * std::min(m_query.size(), item.size());
+                if (max_score == 0)
+                    return 0.0f;
+                std::string item_str = item;
+
+                std::transform(item_str.begin(), item_str.end(), item_str.begin(), ::tolower);
+                // fuzzy search
+                for (size_t i = 0; i < m_query.size(); i++) {
+                    char c = m_query[i];
+                    auto it = std::find(item_str.begin(), item_str.end(), c);
+                    if (it != item_str.end()) {
+                        score += SCORE_EQUAL;
+                        item_str.erase(it);
+                    } else {
+                        score += SCORE_NOT_SAME;
+                    }
+                }
+                return score / max_score;
+            }
+
+            bool filter_step()
+            {
+                size_t end = std::min(m_scan_index + FILTER_SLICE, m_items.size());
+                for (; m_scan_index < end; m_scan_index++) {
+                    float score_percent = score(m_items[m_scan_index]);
+                    if (score_percent > 0.60f) {
+                        m_matches.emplace_back(m_scan_index, score_percent);
+                    }
+                }
+                if (m_scan_index < m_items.size())
+                    return false;
+
+                std::stable_sort(m_matches.begin(), m_matches.end(), [](const std::pair<size_t, float>& lhs, const std::pair<size_t, float>& rhs) {
+                    return lhs.second > rhs.second;
+                });
+                m_filtered_combo.clear();
+                for (auto& match : m_matches) {
+                    m_filtered_combo.add_item(m_items[match.first]);
+                }
+                m_filtered_combo.set_current_item_index(0);
+                m_matches.clear();
+                Metrics::observe_fuzzy_search(Trace::now() - m_filter_begin);
+                mark_changed();
+                return true;
+            }
+
+            void restart_filter()
+            {
+                m_job.cancel();
+                m_scan_index = 0;
+                m_matches.clear();
+                m_filter_begin = Trace::now();
+                // An empty query matches nothing, no need to scan the items for it.
+                if (m_query.empty())
+                {
+                    m_scan_index = m_items.size();
+                    filter_step();
+                    return;
+                }
+
+                Scheduler *scheduler = Scheduler::current();
+                if (scheduler != nullptr)
+                {
+                    m_job = scheduler->schedule([this] { return filter_step(); });
+                    return;
+                }
+                while (!filter_step())
+                {
+                }
+            }
+        
+        public:
+            FuzzyCombo(const std::string& name, int current_item = 0)
+                : m_name(name)
+                , m_input_text(name, 256)
+                , m_filtered_combo(name, current_item)
+            {
+            }
+
+            ~FuzzyCombo()
+            {
+                m_job.cancel();
+            }
+
+            InputText& get_input_text()
+            {
+                return m_input_text;
+            }
+
+            void set_items(const std::vector<std::string>& items)
+            {
+                m_items = items;
+                m_items_dirty = true;
+                mark_changed();
+            }
+
+            // Filtering runs again only when the query or the items change. Inside a Window it is
+            // spread over frames through the window's Scheduler, otherwise it completes immediately.
+            virtual void update() override
+            {
+                ImGui::BeginGroup();
+                m_input_text.update();
+
+                std::string input_text = m_input_text.get_ctext();
+                std::transform(input_text.begin(), input_text.end(), input_text.begin(), ::tolower);
+                if (m_items_dirty || input_text != m_query)
+                {
+                    m_query = std::move(input_text);
+                    m_items_dirty = false;
+                    restart_filter();
+                }
+                m_filtered_combo.update();
+
+                ImGui::EndGroup();
+            }
+
+            bool is_filtering() const
+            {
+                return m_job.is_pending();
+            }
+
+            Combo& get_filtered_combo()
+            {
+                return m_filtered_combo;
+            }
+
+            virtual size_t trim(float max_slack) override
+            {
+                size_t released = MemoryTrim::shrink(m_items, max_slack) + MemoryTrim::shrink(m_query, max_slack) + m_filtered_combo.trim(max_slack);
+                if (!is_filtering())
+                    released += MemoryTrim::shrink(m_matches, max_slack);
+                return released;
+            }
+
+            virtual void report_memory(MemoryReport& report) const override
+            {
+                report.add(MemoryReport::bytes_of(m_name) + MemoryReport::bytes_of(m_items) + MemoryReport::bytes_of(m_query) + MemoryReport::bytes_of(m_matches));
+                m_input_text.report_memory(report);
+                m_filtered_combo.report_memory(report);
+            }
+
+            virtual const std::string& get_name() const override
+            {
+                return m_name;
+            }
+        };
+
+        using GuiFuzzyCombo = Ref<FuzzyCombo>;
+        using GuiFuzzyComboPtr = FuzzyCombo *;
+
+        class HeightIndex
+        {
+        private:
+            std::vector<double> m_tree;
+            std::vector<float> m_values;
+
+        public:
+            size_t size() const
+            {
+                return m_values.size();
+            }
+
+            size_t get_memory_bytes() const
+            {
+                return MemoryReport::bytes_of(m_tree) + MemoryReport::bytes_of(m_values);
+            }
+
+            size_t trim(float max_slack)
+            {
+                return MemoryTrim::shrink(m_tree, max_slack) + MemoryTrim::shrink(m_values, max_slack);
+            }
+
+            void clear()
+            {
+                m_tree.clear();
+                m_values.clear();
+            }
+
+            void push_back(float value)
+            {
+                size_t index = m_values.size() + 1;
+                size_t low = index & (~index + 1);
+                m_values.push_back(value);
+                m_tree.push_back(value + prefix(index - 1) - prefix(index - low));
+            }
+
+            void set(size_t index, float value)
+            {
+                double delta = (double)value - m_values[index];
+                m_values[index] = value;
+                for (size_t i = index + 1; i <= m_tree.size(); i += i & (~i + 1))
+                {
+                    m_tree[i - 1] += delta;
+                }
+            }
+
+            float get(size_t index) const
+            {
+                return m_values[index];
+            }
+
+            // Sum of the first count values.
+            double prefix(size_t count) const
+            {
+                double sum = 0.0;
+                for (size_t i = count; i > 0; i -= i & (~i + 1))
+                {
+                    sum += m_tree[i - 1];
+                }
+                return sum;
+            }
+
+            double total() const
+            {
+                return prefix(m_tree.size());
+            }
+
+            // Index of the item containing offset, clamped to the valid range.
+            size_t find(double offset) const
+            {
+                size_t position = 0;
+                size_t step = 1;
+                while (step * 2 <= m_tree.size())
+                {
+                    step *= 2;
+                }
+                for (; step > 0; step /= 2)
+                {
+                    if (position + step <= m_tree.size() && m_tree[position + step - 1] <= offset)
+                    {
+                        position += step;
+                        offset -= m_tree[position - 1];
+                    }
+                }
+                return std::min(position, m_tree.empty() ? 0 : m_tree.size() - 1);
+            }
+        };
+
+        class Child : public Object
+        {
+        private:
+            std::string m_name;
+            std::vector<GuiObject> m_children;
+            bool m_virtualized = false;
+            float m_estimated_height = 0.0f;
+            HeightIndex m_heights;
+            bool m_cached = false;
+            bool m_dirty = true;
+            DrawCache m_cache;
+            std::shared_ptr<ChangeFlag> m_children_flag = std::make_shared<ChangeFlag>();
+
+            void update_children()
+            {
+                if (m_virtualized && !DrawChecksum::is_reference_mode())
+                {
+                    update_virtualized();
+                    return;
+                }
+                for (auto& child : m_children)
+                {
+                    update_object(*child);
+                }
+            }
+
+            void update_virtualized()
+            {
+                if (m_estimated_height <= 0.0f)
+                    m_estimated_height = ImGui::GetFrameHeightWithSpacing();
+                while (m_heights.size() < m_children.size())
+                {
+                    m_heights.push_back(m_estimated_height);
+                }
+                if (m_children.empty())
+                    return;
+
+                float origin = ImGui::GetCursorPosY();
+                float view_begin = ImGui::GetScrollY();
+                float view_end = view_begin + ImGui::GetWindowHeight();
+
+                size_t index = m_heights.find(view_begin - origin);
+                size_t drawn = 0;
+                ImGui::SetCursorPosY(origin + (float)m_heights.prefix(index));
+                for (; index < m_children.size(); index++)
+                {
+                    float top = ImGui::GetCursorPosY();
+                    update_object(*m_children[index]);
+                    drawn++;
+                    float height = ImGui::GetCursorPosY() - top;
+                    if (height != m_heights.get(index))
+                        m_heights.set(index, height);
+                    if (top + height >= view_end)
+                        break;
+                }
+                Metrics::add_culled(m_children.size() - drawn);
+                ImGui::SetCursorPosY(origin + (float)m_heights.total());
+                ImGui::Dummy(ImVec2(0.0f, 0.0f));
+            }
+        
+        public:
+            Child(const std::string& name)
+                : m_name(name)
+            {
+            }
+
+            virtual void update() override
+            {
+                DrawCache::note_window();
+                ImGui::BeginChild(m_name.c_str());
+                if (m_children_flag->consume())
+                    m_dirty = true;
+                if (m_cached)
+                    m_cache.update(m_dirty, [this] { update_children(); });
+                else
+                    update_children();
+                ImGui::EndChild();
+            }
+
+            Child& set_name(const std::string& name)
+            {
+                m_name = name;
+                return *this;
+            }
+
+            // Only the children intersecting the scroll region are updated. Heights are measured
+            // when a child is drawn; children never drawn yet count as estimated_height
+            // (0 uses the frame height with spacing).
+            Child& set_virtualized(bool virtualized, float estimated_height = 0.0f)
+            {
+                m_virtualized = virtualized;
+                m_estimated_height = estimated_height;
+                m_heights.clear();
+                return *this;
+            }
+
+            // See Window::set_cached.
+            Child& set_cached(bool cached)
+            {
+                m_cached = cached;
+                m_cache.invalidate();
+                return *this;
+            }
+
+            Child& mark_dirty()
+            {
+                m_dirty = true;
+                return *this;
+            }
+
+            Child& add_child(GuiObject child)
+            {
+                child->attach(m_children_flag);
+                m_children.push_back(std::move(child));
+                m_dirty = true;
+                return *this;
+            }
+
+            Child& add_child(GuiObjectPtr child)
+            {
+                child->attach(m_children_flag);
+                m_children.push_back(GuiObject(child));
+                m_dirty = true;
+                return *this;
+            }
+
+            virtual void attach(const std::shared_ptr<ChangeFlag>& flag) override
+            {
+                Object::attach(flag);
+                m_children_flag->set_parent(flag);
+            }
+
+            virtual size_t trim(float max_slack) override
+            {
+                size_t released = MemoryTrim::shrink(m_children, max_slack) + m_heights.trim(max_slack) + m_cache.trim(max_slack);
+                for (auto& child : m_children)
+                {
+                    released += child->trim(max_slack);
+                }
+                return released;
+            }
+
+            virtual void report_memory(MemoryReport& report) const override
+            {
+                report.add(MemoryReport::bytes_of(m_name) + MemoryReport::bytes_of(m_children) + m_heights.get_memory_bytes() + m_cache.get_memory_bytes());
+                for (auto& child : m_children)
+                {
+                    report.report(*child);
+                }
+            }
+
+            virtual const std::string& get_name() const override
+            {
+                return m_name;
+            }
+        };
+
+        using GuiChild = Ref<Child>;
+        using GuiChildPtr = Child *;
+
+        class Table : public Object
+        {
+        private:
+            struct Column
+            {
+                std::string name;
+                ImGuiTableColumnFlags flags;
+                float width;
+            };
+
+            std::string m_name;
+            std::vector<Column> m_columns;
+            std::function<void(size_t row, int column)> m_row_provider;
+            std::function<int(size_t lhs, size_t rhs, int column)> m_compare;
+            std::vector<uint32_t> m_order;
+            std::vector<ImGuiTableColumnSortSpecs> m_sort_specs;
+            ImGuiTableFlags m_flags = ImGuiTableFlags_Resizable | ImGuiTableFlags_Reorderable | ImGuiTableFlags_Hideable
+                | ImGuiTableFlags_Sortable | ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_ScrollY;
+            ImVec2 m_size = ImVec2(0, 0);
+            ThreadPool *m_pool = nullptr;
+
+            bool row_less(uint32_t lhs, uint32_t rhs) const
+            {
+                for (auto& spec : m_sort_specs)
+                {
+                    int result = m_compare(lhs, rhs, (int)spec.ColumnUserID);
+                    if (result != 0)
+                        return spec.SortDirection == ImGuiSortDirection_Descending ? result > 0 : result < 0;
+                }
+                return lhs < rhs;
+            }
+
+            bool is_sorted_by_columns() const
+            {
+                return m_compare != nullptr && !m_sort_specs.empty();
+            }
+
+        public:
+            Table(const std::string& name, const std::function<void(size_t row, int column)>& row_provider)
+                : m_name(name), m_row_provider(row_provider)
+            {
+            }
+
+            virtual void update() override
+            {
+                if (m_flags & (ImGuiTableFlags_ScrollX | ImGuiTableFlags_ScrollY))
+                    DrawCache::note_window();
+                if (m_columns.empty() || !ImGui::BeginTable(m_name.c_str(), (int)m_columns.size(), m_flags, m_size))
+                    return;
+
+                ImGui::TableSetupScrollFreeze(0, 1);
+                for (size_t i = 0; i < m_columns.size(); i++)
+                {
+                    ImGui::TableSetupColumn(m_columns[i].name.c_str(), m_columns[i].flags, m_columns[i].width, (ImGuiID)i);
+                }
+                ImGui::TableHeadersRow();
+
+                ImGuiTableSortSpecs *specs = ImGui::TableGetSortSpecs();
+                if (specs && specs->SpecsDirty)
+                {
+                    m_sort_specs.assign(specs->Specs, specs->Specs + specs->SpecsCount);
+                    sort();
+                    specs->SpecsDirty = false;
+                }
+
+                ImGuiListClipper clipper;
+                clipper.Begin((int)m_order.size());
+                while (clipper.Step())
+                {
+                    for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
+                    {
+                        uint32_t row = m_order[i];
+                        ImGui::TableNextRow();
+                        ImGui::PushID((int)row);
+                        for (int column = 0; column < (int)m_columns.size(); column++)
+                        {
+                            if (ImGui::TableSetColumnIndex(column))
+                                m_row_provider(row, column);
+                        }
+                        ImGui::PopID();
+                    }
+                }
+                ImGui::EndTable();
+            }
+
+            Table& add_column(const std::string& name, ImGuiTableColumnFlags flags = 0, float width = 0.0f)
+            {
+                m_columns.push_back({name, flags, width});
+                return *this;
+            }
+
+            Table& set_name(const std::string& name)
+            {
+                m_name = name;
+                return *this;
+            }
+
+            Table& set_row_provider(const std::function<void(size_t row, int column)>& row_provider)
+            {
+                m_row_provider = row_provider;
+                return *this;
+            }
+
+            // Called concurrently from the thread pool while sorting, so it must be thread safe.
+            // Returns a negative value, zero or a positive value like strcmp.
+            Table& set_compare(const std::function<int(size_t lhs, size_t rhs, int column)>& compare)
+            {
+                m_compare = compare;
+                return sort();
+            }
+
+            Table& set_flags(ImGuiTableFlags flags)
+            {
+                m_flags = flags;
+                return *this;
+            }
+
+            Table& set_size(const ImVec2& size)
+            {
+                m_size = size;
+                return *this;
+            }
+
+            // See ThreadPool::parallel_sort_on().
+            Table& set_thread_pool(ThreadPool *pool)
+            {
+                m_pool = pool;
+                return *this;
+            }
+
+            Table& set_row_count(size_t row_count)
+            {
+                if (row_count < m_order.size())
+                {
+                    m_order.resize(row_count);
+                    std::iota(m_order.begin(), m_order.end(), 0u);
+                    return sort();
+                }
+                return add_rows(row_count - m_order.size());
+            }
+
+            Table& add_rows(size_t count)
+            {
+                size_t old_size = m_order.size();
+                m_order.resize(old_size + count);
+                std::iota(m_order.begin() + old_size, m_order.end(), (uint32_t)old_size);
+                if (is_sorted_by_columns() && count != 0)
+                {
+                    auto less = [this](uint32_t lhs, uint32_t rhs) { return row_less(lhs, rhs); };
+                    ThreadPool::parallel_sort_on(m_pool, m_order.begin() + old_size, m_order.end(), less);
+                    std::inplace_merge(m_order.begin(), m_order.begin() + old_size, m_order.end(), less);
+                }
+                return *this;
+            }
+
+            Table& sort()
+            {
+                if (!is_sorted_by_columns())
+                {
+                    std::iota(m_order.begin(), m_order.end(), 0u);
+                    return *this;
+                }
+                ThreadPool::parallel_sort_on(m_pool, m_order.begin(), m_order.end(), [this](uint32_t lhs, uint32_t rhs) {
+                    return row_less(lhs, rhs);
+                });
+                return *this;
+            }
+
+            size_t get_row_count() const
+            {
+                return m_order.size();
+            }
+
+            size_t get_row(size_t display_index) const
+            {
+                return m_order[display_index];
+            }
+
+            const std::vector<uint32_t>& get_order() const
+            {
+                return m_order;
+            }
+
+            virtual size_t trim(float max_slack) override
+            {
+                return MemoryTrim::shrink(m_columns, max_slack) + MemoryTrim::shrink(m_order, max_slack) + MemoryTrim::shrink(m_sort_specs, max_slack);
+            }
+
+            virtual void report_memory(MemoryReport& report) const override
+            {
+                size_t bytes = MemoryReport::bytes_of(m_name) + MemoryReport::bytes_of(m_columns) + MemoryReport::bytes_of(m_order) + MemoryReport::bytes_of(m_sort_specs);
+                for (const Column& column : m_columns)
+                {
+                    bytes += MemoryReport::bytes_of(column.name);
+                }
+                report.add(bytes).add_callback(m_row_provider).add_callback(m_compare);
+            }
+
+            virtual const std::string& get_name() const override
+            {
+                return m_name;
+            }
+        };
+
+        using GuiTable = Ref<Table>;
+        using GuiTablePtr = Table *;
+
+        struct TreeItem
+        {
+            uint64_t id;
+            std::string label;
+            bool leaf;
+        };
+
+        class Tree : public Object
+        {
+        private:
+            struct Node
+            {
+                uint64_t id;
+                std::string label;
+                uint32_t first_child;
+                uint32_t child_count;
+                uint32_t depth;
+                bool leaf;
+                bool loaded;
+                bool expanded;
+            };
+
+            static constexpr uint32_t npos = UINT32_MAX;
+
+            std::string m_name;
+            uint64_t m_root_id = 0;
+            std::function<void(uint64_t id, std::vector<TreeItem>& children)> m_provider;
+            std::function<void(uint64_t id)> m_on_select;
+            std::vector<Node> m_nodes;
+            std::vector<uint32_t> m_visible;
+            std::vector<TreeItem> m_scratch;
+            uint32_t m_root_first = 0;
+            uint32_t m_root_count = 0;
+            uint32_t m_selected = npos;
+            bool m_loaded = false;
+            ImVec2 m_size = ImVec2(0, 0);
+
+            void load_children(uint64_t id, uint32_t depth, uint32_t& first, uint32_t& count)
+            {
+                m_scratch.clear();
+                m_provider(id, m_scratch);
+                first = (uint32_t)m_nodes.size();
+                count = (uint32_t)m_scratch.size();
+                m_nodes.reserve(m_nodes.size() + m_scratch.size());
+                for (auto& item : m_scratch)
+                {
+                    m_nodes.push_back({item.id, std::move(item.label), 0, 0, depth, item.leaf, item.leaf, false});
+                }
+            }
+
+            void load_roots()
+            {
+                m_nodes.clear();
+                m_visible.clear();
+                m_selected = npos;
+                load_children(m_root_id, 0, m_root_first, m_root_count);
+                for (uint32_t i = 0; i < m_root_count; i++)
+                {
+                    m_visible.push_back(m_root_first + i);
+                }
+                m_loaded = true;
+            }
+
+            void append_visible(uint32_t index, std::vector<uint32_t>& out) const
+            {
+                const Node& node = m_nodes[index];
+                for (uint32_t i = 0; i < node.child_count; i++)
+                {
+                    uint32_t child = node.first_child + i;
+                    out.push_back(child);
+                    if (m_nodes[child].expanded)
+                        append_visible(child, out);
+                }
+            }
+
+            void expand(size_t position)
+            {
+                uint32_t index = m_visible[position];
+                if (!m_nodes[index].loaded)
+                {
+                    uint32_t first = 0;
+                    uint32_t count = 0;
+                    load_children(m_nodes[index].id, m_nodes[index].depth + 1, first, count);
+                    m_nodes[index].first_child = first;
+                    m_nodes[index].child_count = count;
+                    m_nodes[index].loaded = true;
+                }
+                m_nodes[index].expanded = true;
+
+                std::vector<uint32_t> subtree;
+                append_visible(index, subtree);
+                m_visible.insert(m_visible.begin() + position + 1, subtree.begin(), subtree.end());
+            }
+
+            void collapse(size_t position)
+            {
+                uint32_t depth = m_nodes[m_visible[position]].depth;
+                size_t end = position + 1;
+                while (end < m_visible.size() && m_nodes[m_visible[end]].depth > depth)
+                {
+                    end++;
+                }
+                m_nodes[m_visible[position]].expanded = false;
+                m_visible.erase(m_visible.begin() + position + 1, m_visible.begin() + end);
+            }
+
+        public:
+            Tree(const std::string& name, const std::function<void(uint64_t id, std::vector<TreeItem>& children)>& provider, uint64_t root_id = 0)
+                : m_name(name), m_root_id(root_id), m_provider(provider)
+            {
+            }
+
+            virtual void update() override
+            {
+                if (!m_loaded)
+                    load_roots();
+
+                size_t toggled = SIZE_MAX;
+                float indent = ImGui::GetStyle().IndentSpacing;
+
+                DrawCache::note_window();
+                ImGui::BeginChild(m_name.c_str(), m_size);
+                ImGuiListClipper clipper;
+                clipper.Begin((int)m_visible.size());
+                while (clipper.Step())
+                {
+                    for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
+                    {
+                        uint32_t index = m_visible[i];
+                        const Node& node = m_nodes[index];
+                        ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_NoTreePushOnOpen | ImGuiTreeNodeFlags_OpenOnArrow
+                            | ImGuiTreeNodeFlags_OpenOnDoubleClick | ImGuiTreeNodeFlags_SpanAvailWidth;
+                        if (node.leaf)
+                            flags |= ImGuiTreeNodeFlags_Leaf;
+                        if (index == m_selected)
+                            flags |= ImGuiTreeNodeFlags_Selected;
+
+                        float offset = indent * node.depth;
+                        if (offset > 0.0f)
+                            ImGui::Indent(offset);
+                        ImGui::SetNextItemOpen(node.expanded, ImGuiCond_Always);
+                        bool open = ImGui::TreeNodeEx((void *)(intptr_t)index, flags, "%s", node.label.c_str());
+                        if (ImGui::IsItemClicked() && !ImGui::IsItemToggledOpen())
+                        {
+                            m_selected = index;
+                            if (m_on_select)
+                                m_on_select(node.id);
+                        }
+                        if (open != node.expanded && !node.leaf)
+                            toggled = i;
+                        if (offset > 0.0f)
+                            ImGui::Unindent(offset);
+                    }
+                }
+                ImGui::EndChild();
+
+                if (toggled != SIZE_MAX)
+                {
+                    if (m_nodes[m_visible[toggled]].expanded)
+                        collapse(toggled);
+                    else
+                        expand(toggled);
+                }
+            }
+
+            Tree& set_name(const std::string& name)
+            {
+                m_name = name;
+                return *this;
+            }
+
+            Tree& set_size(const ImVec2& size)
+            {
+                m_size = size;
+                return *this;
+            }
+
+            Tree& set_on_select(const std::function<void(uint64_t id)>& on_select)
+            {
+                m_on_select = on_select;
+                return *this;
+            }
+
+            Tree& set_provider(const std::function<void(uint64_t id, std::vector<TreeItem>& children)>& provider)
+            {
+                m_provider = provider;
+                return refresh();
+            }
+
+            // Drops every materialized node; children are requested again on the next frame.
+            Tree& refresh()
+            {
+                m_loaded = false;
+                return *this;
+            }
+
+            bool has_selection() const
+            {
+                return m_selected != npos;
+            }
+
+            uint64_t get_selected_id() const
+            {
+                return m_selected != npos ? m_nodes[m_selected].id : 0;
+            }
+
+            size_t get_visible_count() const
+            {
+                return m_visible.size();
+            }
+
+            size_t get_node_count() const
+            {
+                return m_nodes.size();
+            }
+
+            virtual size_t trim(float max_slack) override
+            {
+                return MemoryTrim::shrink(m_nodes, max_slack) + MemoryTrim::shrink(m_visible, max_slack) + MemoryTrim::shrink(m_scratch, max_slack);
+            }
+
+            virtual void report_memory(MemoryReport& report) const override
+            {
+                size_t bytes = MemoryReport::bytes_of(m_name) + MemoryReport::bytes_of(m_nodes) + MemoryReport::bytes_of(m_visible) + MemoryReport::bytes_of(m_scratch);
+                for (const Node& node : m_nodes)
+                {
+                    bytes += MemoryReport::bytes_of(node.label);
+                }
+                report.add(bytes).add_callback(m_provider).add_callback(m_on_select);
+            }
+
+            virtual const std::string& get_name() const override
+            {
+                return m_name;
+            }
+        };
+
+        using GuiTree = Ref<Tree>;
+        using GuiTreePtr = Tree *;
+
+        class Bitset
+        {
+        private:
+            std::vector<uint64_t> m_words;
+            size_t m_size = 0;
+
+            static uint64_t range_mask(size_t first_bit, size_t last_bit)
+            {
+                uint64_t high = last_bit == 64 ? ~0ull : (1ull << last_bit) - 1;
+                return high & ~((1ull << first_bit) - 1);
+            }
+
+            void clear_tail()
+            {
+                if (m_size % 64 != 0)
+                    m_words.back() &= (1ull << (m_size % 64)) - 1;
+            }
+
+        public:
+            static constexpr size_t npos = SIZE_MAX;
+
+            static int popcount(uint64_t word)
+            {
+#if defined(__GNUC__) || defined(__clang__)
+                return __builtin_popcountll(word);
+#else
+                word = word - ((word >> 1) & 0x5555555555555555ull);
+                word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+                word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+                return (int)((word * 0x0101010101010101ull) >> 56);
+#endif
+            }
+
+            // Undefined for 0.
+            static int ctz(uint64_t word)
+            {
+#if defined(__GNUC__) || defined(__clang__)
+                return __builtin_ctzll(word);
+#else
+                int count = 0;
+                while ((word & 1) == 0)
+                {
+                    word >>= 1;
+                    count++;
+                }
+                return count;
+#endif
+            }
+
+            Bitset() = default;
+
+            explicit Bitset(size_t size, bool value = false)
+            {
+                resize(size, value);
+            }
+
+            size_t size() const
+            {
+                return m_size;
+            }
+
+            size_t get_memory_bytes() const
+            {
+                return MemoryReport::bytes_of(m_words);
+            }
+
+            size_t trim(float max_slack)
+            {
+                return MemoryTrim::shrink(m_words, max_slack);
+            }
+
+            void resize(size_t size, bool value = false)
+            {
+                size_t old_size = m_size;
+                m_words.resize((size + 63) / 64, value ? ~0ull : 0ull);
+                m_size = size;
+                if (size > old_size)
+                    set_range(old_size, size, value);
+                clear_tail();
+            }
+
+            bool test(size_t index) const
+            {
+                return (m_words[index / 64] >> (index % 64)) & 1;
+            }
+
+            void set(size_t index, bool value = true)
+            {
+                uint64_t bit = 1ull << (index % 64);
+                if (value)
+                    m_words[index / 64] |= bit;
+                else
+                    m_words[index / 64] &= ~bit;
+            }
+
+            void reset(size_t index)
+            {
+                set(index, false);
+            }
+
+            void flip(size_t index)
+            {
+                m_words[index / 64] ^= 1ull << (index % 64);
+            }
+
+            // Sets the bits in [first, last).
+            void set_range(size_t first, size_t last, bool value = true)
+            {
+                last = std::min(last, m_size);
+                if (first >= last)
+                    return;
+
+                size_t first_word = first / 64;
+                size_t last_word = (last - 1) / 64;
+                for (size_t word = first_word; word <= last_word; word++)
+                {
+                    size_t begin_bit = word == first_word ? first % 64 : 0;
+                    size_t end_bit = word == last_word ? (last - 1) % 64 + 1 : 64;
+                    uint64_t mask = range_mask(begin_bit, end_bit);
+                    if (value)
+                        m_words[word] |= mask;
+                    else
+                        m_words[word] &= ~mask;
+                }
+            }
+
+            void set_all(bool value = true)
+            {
+                std::fill(m_words.begin(), m_words.end(), value ? ~0ull : 0ull);
+                clear_tail();
+            }
+
+            size_t count() const
+            {
+                size_t total = 0;
+                for (uint64_t word : m_words)
+                {
+                    total += popcount(word);
+                }
+                return total;
+            }
+
+            bool any() const
+            {
+                return std::any_of(m_words.begin(), m_words.end(), [](uint64_t word) { return word != 0; });
+            }
+
+            // First set bit at or after from, or npos.
+            size_t find_next(size_t from) const
+            {
+                if (from >= m_size)
+                    return npos;
+                size_t word = from / 64;
+                uint64_t bits = m_words[word] & (~0ull << (from % 64));
+                while (bits == 0)
+                {
+                    if (++word == m_words.size())
+                        return npos;
+                    bits = m_words[word];
+                }
+                return word * 64 + ctz(bits);
+            }
+
+            template <typename F>
+            void for_each_set(F&& callback) const
+            {
+                for (size_t word = 0; word < m_words.size(); word++)
+                {
+                    for (uint64_t bits = m_words[word]; bits != 0; bits &= bits - 1)
+                    {
+                        callback(word * 64 + ctz(bits));
+                    }
+                }
+            }
+
+            uint64_t *data()
+            {
+                return m_words.data();
+            }
+
+            const uint64_t *data() const
+            {
+                return m_words.data();
+            }
+
+            size_t word_count() const
+            {
+                return m_words.size();
+            }
+        };
+
+        class MultiSelectList : public Object
+        {
+        private:
+            std::string m_name;
+            std::vector<std::string> m_items;
+            Bitset m_selection;
+            size_t m_anchor = 0;
+            ImVec2 m_size = ImVec2(0, 0);
+            std::function<void()> m_on_change;
+
+            void click(size_t index, bool ctrl, bool shift)
+            {
+                if (shift)
+                {
+                    if (!ctrl)
+                        m_selection.set_all(false);
+                    m_selection.set_range(std::min(m_anchor, index), std::max(m_anchor, index) + 1);
+                    return;
+                }
+                if (ctrl)
+                {
+                    m_selection.flip(index);
+                }
+                else
+                {
+                    m_selection.set_all(false);
+                    m_selection.set(index);
+                }
+                m_anchor = index;
+            }
+
+        public:
+            MultiSelectList(const std::string& name, const std::vector<std::string>& items = {})
+                : m_name(name)
+            {
+                set_items(items);
+            }
+
+            // Click selects, ctrl-click toggles, shift-click selects a range from the last click
+            // and ctrl+A selects everything while the list is focused.
+            virtual void update() override
+            {
+                DrawCache::note_window();
+                if (!ImGui::BeginListBox(m_name.c_str(), m_size))
+                    return;
+
+                const ImGuiIO& io = ImGui::GetIO();
+                bool changed = false;
+                if (ImGui::IsWindowFocused() && io.KeyCtrl && ImGui::IsKeyPressed(ImGuiKey_A) && !m_items.empty())
+                {
+                    m_selection.set_all(true);
+                    changed = true;
+                }
+
+                ImGuiListClipper clipper;
+                clipper.Begin((int)m_items.size());
+                while (clipper.Step())
+                {
+                    for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
+                    {
+                        ImGui::PushID(i);
+                        if (ImGui::Selectable(m_items[i].c_str(), m_selection.test(i)))
+                        {
+                            click(i, io.KeyCtrl, io.KeyShift);
+                            changed = true;
+                        }
+                        ImGui::PopID();
+                    }
+                }
+                ImGui::EndListBox();
+
+                if (changed && m_on_change)
+                    m_on_change();
+            }
+
+            MultiSelectList& set_name(const std::string& name)
+            {
+                m_name = name;
+                return *this;
+            }
+
+            MultiSelectList& set_items(const std::vector<std::string>& items)
+            {
+                m_items = items;
+                m_selection = Bitset(m_items.size());
+                m_anchor = 0;
+                return *this;
+            }
+
+            MultiSelectList& set_size(const ImVec2& size)
+            {
+                m_size = size;
+                return *this;
+            }
+
+            MultiSelectList& set_on_change(const std::function<void()>& on_change)
+            {
+                m_on_change = on_change;
+                return *this;
+            }
+
+            MultiSelectList& select_all(bool selected = true)
+            {
+                m_selection.set_all(selected);
+                return *this;
+            }
+
+            MultiSelectList& select_range(size_t first, size_t last, bool selected = true)
+            {
+                m_selection.set_range(first, last, selected);
+                return *this;
+            }
+
+            bool is_selected(size_t index) const
+            {
+                return m_selection.test(index);
+            }
+
+            size_t get_selected_count() const
+            {
+                return m_selection.count();
+            }
+
+            const Bitset& get_selection() const
+            {
+                return m_selection;
+            }
+
+            const std::vector<std::string>& get_items() const
+            {
+                return m_items;
+            }
+
+            virtual size_t trim(float max_slack) override
+            {
+                return MemoryTrim::shrink(m_items, max_slack) + m_selection.trim(max_slack);
+            }
+
+            virtual void report_memory(MemoryReport& report) const override
+            {
+                report.add(MemoryReport::bytes_of(m_name) + MemoryReport::bytes_of(m_items) + m_selection.get_memory_bytes()).add_callback(m_on_change);
+            }
+
+            virtual const std::string& get_name() const override
+            {
+                return m_name;
+            }
+        };
+
+        using GuiMultiSelectList = Ref<MultiSelectList>;
+        using GuiMultiSelectListPtr = MultiSelectList *;
+
+        class CheckboxGroup : public Object
+        {
+        private:
+            std::string m_name;
+            uint64_t *m_words;
+            size_t m_count;
+            Bitset *m_bits = nullptr;
+            std::function<const char *(size_t index)> m_names;
+            std::function<void(size_t index, bool value)> m_on_change;
+            ImVec2 m_size = ImVec2(0, 0);
+
+        public:
+            // Edits count bits of words in place; words is not owned.
+            CheckboxGroup(const std::string& name, uint64_t *words, size_t count, const std::function<const char *(size_t index)>& names)
+                : m_name(name), m_words(words), m_count(count), m_names(names)
+            {
+            }
+
+            // Follows bits as it grows or shrinks; bits is not owned.
+            CheckboxGroup(const std::string& name, Bitset *bits, const std::function<const char *(size_t index)>& names)
+                : m_name(name), m_words(nullptr), m_count(0), m_bits(bits), m_names(names)
+            {
+            }
+
+            virtual void update() override
+            {
+                uint64_t *words = m_bits != nullptr ? m_bits->data() : m_words;
+                size_t count = get_count();
+                DrawCache::note_window();
+                ImGui::BeginChild(m_name.c_str(), m_size);
+                ImGuiListClipper clipper;
+                clipper.Begin((int)count);
+                while (clipper.Step())
+                {
+                    for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
+                    {
+                        uint64_t& word = words[i / 64];
+                        uint64_t bit = 1ull << (i % 64);
+                        bool value = (word & bit) != 0;
+
+                        ImGui::PushID(i);
+                        if (ImGui::Checkbox(m_names(i), &value))
+                        {
+                            word = value ? (word | bit) : (word & ~bit);
+                            if (m_on_change)
+                                m_on_change(i, value);
+                        }
+                        ImGui::PopID();
+                    }
+                }
+                ImGui::EndChild();
+            }
+
+            CheckboxGroup& set_name(const std::string& name)
+            {
+                m_name = name;
+                return *this;
+            }
+
+            CheckboxGroup& set_bits(uint64_t *words, size_t count)
+            {
+                m_words = words;
+                m_count = count;
+                m_bits = nullptr;
+                return *this;
+            }
+
+            CheckboxGroup& set_bits(Bitset *bits)
+            {
+                m_bits = bits;
+                return *this;
+            }
+
+            CheckboxGroup& set_names(const std::function<const char *(size_t index)>& names)
+            {
+                m_names = names;
+                return *this;
+            }
+
+            CheckboxGroup& set_on_change(const std::function<void(size_t index, bool value)>& on_change)
+            {
+                m_on_change = on_change;
+                return *this;
+            }
+
+            CheckboxGroup& set_size(const ImVec2& size)
+            {
+                m_size = size;
+                return *this;
+            }
+
+            bool get_value(size_t index) const
+            {
+                const uint64_t *words = m_bits != nullptr ? m_bits->data() : m_words;
+                return (words[index / 64] >> (index % 64)) & 1;
+            }
+
+            size_t get_count() const
+            {
+                return m_bits != nullptr ? m_bits->size() : m_count;
+            }
+
+            virtual void report_memory(MemoryReport& report) const override
+            {
+                report.add(MemoryReport::bytes_of(m_name)).add_callback(m_names).add_callback(m_on_change);
+            }
+
+            virtual const std::string& get_name() const override
+            {
+                return m_name;
+            }
+        };
+
+        using GuiCheckboxGroup = Ref<CheckboxGroup>;
+        using GuiCheckboxGroupPtr = CheckboxGroup *;
+
+        class FlameGraph : public Object
+        {
+        private:
+            static constexpr uint32_t npos = UINT32_MAX;
+
+            std::string m_name;
+            std::vector<uint32_t> m_parent;
+            std::vector<float> m_self_time;
+            std::vector<uint32_t> m_name_id;
+            std::vector<std::string> m_names;
+
+            std::vector<double> m_x;
+            std::vector<double> m_total;
+            std::vector<uint32_t> m_depth;
+            std::vector<uint32_t> m_subtree_end;
+            double m_grand_total = 0.0;
+            uint32_t m_max_depth = 0;
+
+            double m_view_begin = 0.0;
+            double m_view_end = 1.0;
+            float m_row_height = 0.0f;
+            float m_height = 0.0f;
+            float m_min_width = 1.0f;
+            bool m_icicle = false;
+
+            void layout()
+            {
+                size_t count = m_parent.size();
+                m_x.assign(count, 0.0);
+                m_total.assign(m_self_time.begin(), m_self_time.end());
+                m_depth.assign(count, 0);
+                m_subtree_end.resize(count);
+                std::iota(m_subtree_end.begin(), m_subtree_end.end(), 1u);
+                m_grand_total = 0.0;
+                m_max_depth = 0;
+
+                for (size_t i = count; i-- > 0;)
+                {
+                    uint32_t parent = m_parent[i];
+                    if (parent == npos)
+                        continue;
+                    m_total[parent] += m_total[i];
+                    m_subtree_end[parent] = std::max(m_subtree_end[parent], m_subtree_end[i]);
+                }
+
+                std::vector<double> next_child(count);
+                for (size_t i = 0; i < count; i++)
+                {
+                    uint32_t parent = m_parent[i];
+                    if (parent == npos)
+                    {
+                        m_x[i] = m_grand_total;
+                        m_grand_total += m_total[i];
+                    }
+                    else
+                    {
+                        m_x[i] = next_child[parent];
+                        next_child[parent] += m_total[i];
+                        m_depth[i] = m_depth[parent] + 1;
+                        m_max_depth = std::max(m_max_depth, m_depth[i]);
+                    }
+                    next_child[i] = m_x[i];
+                }
+                reset_view();
+            }
+
+            static ImU32 frame_color(uint32_t name_id)
+            {
+                uint32_t hash = name_id * 2654435761u;
+                return IM_COL32(205 + (hash >> 8) % 50, 80 + (hash >> 16) % 150, 40 + (hash >> 24) % 50, 255);
+            }
+
+        public:
+            FlameGraph(const std::string& name)
+                : m_name(name)
+            {
+            }
+
+            // Frames must be in depth-first pre-order: parent[i] < i, npos (UINT32_MAX) for roots.
+            // name_id indexes names. Layout is computed once here, in O(n).
+            FlameGraph& set_frames(std::vector<uint32_t> parent, std::vector<float> self_time, std::vector<uint32_t> name_id, std::vector<std::string> names)
+            {
+                m_parent = std::move(parent);
+                m_self_time = std::move(self_time);
+                m_name_id = std::move(name_id);
+                m_names = std::move(names);
+                layout();
+                mark_changed();
+                return *this;
+            }
+
+            // Culled or sub-pixel frames skip their whole subtree, so the cost follows what is visible.
+            virtual void update() override
+            {
+                float row_height = m_row_height > 0.0f ? m_row_height : ImGui::GetFrameHeight();
+                float width = std::max(ImGui::GetContentRegionAvail().x, 1.0f);
+                float height = m_height > 0.0f ? m_height : row_height * (m_max_depth + 1);
+                ImVec2 origin = ImGui::GetCursorScreenPos();
+
+                ImGui::InvisibleButton(m_name.c_str(), ImVec2(width, std::max(height, 1.0f)));
+                bool hovered = ImGui::IsItemHovered();
+                const ImGuiIO& io = ImGui::GetIO();
+                double span = std::max(m_view_end - m_view_begin, 1e-12);
+                double scale = width / span;
+
+                if (hovered && io.MouseWheel != 0.0f)
+                {
+                    double pivot = m_view_begin + (io.MousePos.x - origin.x) / scale;
+                    double factor = std::pow(0.8, (double)io.MouseWheel);
+                    m_view_begin = pivot - (pivot - m_view_begin) * factor;
+                    m_view_end = pivot + (m_view_end - pivot) * factor;
+                }
+                if (ImGui::IsItemActive() && ImGui::IsMouseDragging(ImGuiMouseButton_Left))
+                {
+                    double delta = io.MouseDelta.x / scale;
+                    m_view_begin -= delta;
+                    m_view_end -= delta;
+                }
+                if (hovered && (ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left) || ImGui::IsMouseClicked(ImGuiMouseButton_Right)))
+                    reset_view();
+                span = std::max(m_view_end - m_view_begin, 1e-12);
+                scale = width / span;
+
+                ImDrawList *draw_list = ImGui::GetWindowDrawList();
+                ImFont *font = ImGui::GetFont();
+                float font_size = ImGui::GetFontSize();
+                float clip_top = std::max(draw_list->GetClipRectMin().y, origin.y);
+                float clip_bottom = std::min(draw_list->GetClipRectMax().y, origin.y + height);
+                float right = origin.x + width;
+                ImU32 text_color = IM_COL32_BLACK;
+                size_t hovered_frame = SIZE_MAX;
+
+                draw_list->PushClipRect(origin, ImVec2(right, origin.y + height), true);
+                for (size_t i = 0; i < m_parent.size();)
+                {
+                    float x0 = origin.x + (float)((m_x[i] - m_view_begin) * scale);
+                    float x1 = x0 + (float)(m_total[i] * scale);
+                    uint32_t row = m_icicle ? m_depth[i] : m_max_depth - m_depth[i];
+                    float y0 = origin.y + row * row_height;
+                    float y1 = y0 + row_height - 1.0f;
+                    bool beyond = m_icicle ? y0 > clip_bottom : y1 < clip_top;
+                    if (x1 < origin.x || x0 > right || x1 - x0 < m_min_width || beyond)
+                    {
+                        i = m_subtree_end[i];
+                        continue;
+                    }
+
+                    if (y1 >= clip_top && y0 <= clip_bottom)
+                    {
+                        ImVec2 min(std::max(x0, origin.x), y0);
+                        ImVec2 max(std::min(x1, right), y1);
+                        draw_list->AddRectFilled(min, max, frame_color(m_name_id[i]));
+                        if (max.x - min.x > font_size * 2.0f)
+                        {
+                            const std::string& label = m_names[m_name_id[i]];
+                            ImVec4 clip(min.x + 2.0f, min.y, max.x - 2.0f, max.y);
+                            draw_list->AddText(font, font_size, ImVec2(min.x + 2.0f, y0 + (row_height - font_size) * 0.5f), text_color,
+                                label.data(), label.data() + label.size(), 0.0f, &clip);
+                        }
+                        if (hovered && io.MousePos.x >= min.x && io.MousePos.x < max.x && io.MousePos.y >= y0 && io.MousePos.y < y1 + 1.0f)
+                            hovered_frame = i;
+                    }
+                    i++;
+                }
+                draw_list->PopClipRect();
+
+                if (hovered_frame != SIZE_MAX)
+                {
+                    if (ImGui::IsItemClicked(ImGuiMouseButton_Left) && !ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left))
+                        zoom_to(hovered_frame);
+                    ImGui::SetTooltip("%s\ntotal: %.3f (%.2f%%)\nself: %.3f", m_names[m_name_id[hovered_frame]].c_str(), m_total[hovered_frame],
+                        m_grand_total > 0.0 ? 100.0 * m_total[hovered_frame] / m_grand_total : 0.0, (double)m_self_time[hovered_frame]);
+                }
+            }
+
+            FlameGraph& zoom_to(size_t frame)
+            {
+                m_view_begin = m_x[frame];
+                m_view_end = m_x[frame] + std::max(m_total[frame], 1e-12);
+                return *this;
+            }
+
+            FlameGraph& reset_view()
+            {
+                m_view_begin = 0.0;
+                m_view_end = m_grand_total > 0.0 ? m_grand_total : 1.0;
+                return *this;
+            }
+
+            FlameGraph& set_name(const std::string& name)
+            {
+                m_name = name;
+                return *this;
+            }
+
+            // 0 uses the frame height.
+            FlameGraph& set_row_height(float row_height)
+            {
+                m_row_height = row_height;
+                return *this;
+            }
+
+            // 0 fits every level.
+            FlameGraph& set_height(float height)
+            {
+                m_height = height;
+                return *this;
+            }
+
+            // Frames narrower than this many pixels are culled with their subtree.
+            FlameGraph& set_min_width(float min_width)
+            {
+                m_min_width = min_width;
+                return *this;
+            }
+
+            // Roots at the top instead of the bottom.
+            FlameGraph& set_icicle(bool icicle)
+            {
+                m_icicle = icicle;
+                return *this;
+            }
+
+            size_t get_frame_count() const
+            {
+                return m_parent.size();
+            }
+
+            double get_total(size_t frame) const
+            {
+                return m_total[frame];
+            }
+
+            virtual size_t trim(float max_slack) override
+            {
+                return MemoryTrim::shrink(m_parent, max_slack) + MemoryTrim::shrink(m_self_time, max_slack) + MemoryTrim::shrink(m_name_id, max_slack)
+                    + MemoryTrim::shrink(m_names, max_slack) + MemoryTrim::shrink(m_x, max_slack) + MemoryTrim::shrink(m_total, max_slack)
+                    + MemoryTrim::shrink(m_depth, max_slack) + MemoryTrim::shrink(m_subtree_end, max_slack);
+            }
+
+            virtual void report_memory(MemoryReport& report) const override
+            {
+                report.add(MemoryReport::bytes_of(m_name) + MemoryReport::bytes_of(m_parent) + MemoryReport::bytes_of(m_self_time) + MemoryReport::bytes_of(m_name_id)
+                    + MemoryReport::bytes_of(m_names) + MemoryReport::bytes_of(m_x) + MemoryReport::bytes_of(m_total) + MemoryReport::bytes_of(m_depth)
+                    + MemoryReport::bytes_of(m_subtree_end));
+            }
+
+            virtual const std::string& get_name() const override
+            {
+                return m_name;
+            }
+        };
+
+        using GuiFlameGraph = Ref<FlameGraph>;
+        using GuiFlameGraphPtr = FlameGraph *;
+
+        class Timeline : public Object
+        {
+        private:
+            struct Lane
+            {
+                std::string name;
+                std::vector<double> start;
+                std::vector<double> end;
+                std::vector<double> max_end;
+                std::vector<uint32_t> label;
+                bool sorted = true;
+            };
+
+            std::string m_name;
+            std::vector<Lane> m_lanes;
+            std::vector<std::string> m_labels;
+            double m_view_begin = 0.0;
+            double m_view_end = 1.0;
+            float m_lane_height = 0.0f;
+            float m_lane_name_width = 120.0f;
+            float m_height = 0.0f;
+            float m_min_width = 1.0f;
+            ThreadPool *m_pool = nullptr;
+
+            static ImU32 label_color(uint32_t label)
+            {
+                uint32_t hash = label * 2654435761u;
+                return IM_COL32(60 + (hash >> 8) % 140, 90 + (hash >> 16) % 130, 120 + (hash >> 24) % 120, 255);
+            }
+
+            void sort_lane(Lane& lane) const
+            {
+                size_t count = lane.start.size();
+                std::vector<uint32_t> order(count);
+                std::iota(order.begin(), order.end(), 0u);
+                ThreadPool::parallel_sort_on(m_pool, order.begin(), order.end(), [&lane](uint32_t lhs, uint32_t rhs) {
+                    return lane.start[lhs] < lane.start[rhs] || (lane.start[lhs] == lane.start[rhs] && lhs < rhs);
+                });
+
+                std::vector<double> start(count);
+                std::vector<double> end(count);
+                std::vector<uint32_t> label(count);
+                for (size_t i = 0; i < count; i++)
+                {
+                    start[i] = lane.start[order[i]];
+                    end[i] = lane.end[order[i]];
+                    label[i] = lane.label[order[i]];
+                }
+                lane.start.swap(start);
+                lane.end.swap(end);
+                lane.label.swap(label);
+
+                double max_end = -DBL_MAX;
+                for (size_t i = 0; i < count; i++)
+                {
+                    max_end = std::max(max_end, lane.end[i]);
+                    lane.max_end[i] = max_end;
+                }
+                lane.sorted = true;
+            }
+
+            void draw_lane(ImDrawList *draw_list, Lane& lane, float left, float right, float y0, float y1, double scale, size_t& hovered_lane, size_t& hovered_event, size_t lane_index)
+            {
+                if (!lane.sorted)
+                    sort_lane(lane);
+
+                const ImGuiIO& io = ImGui::GetIO();
+                ImFont *font = ImGui::GetFont();
+                float font_size = ImGui::GetFontSize();
+                bool mouse_in_lane = io.MousePos.y >= y0 && io.MousePos.y < y1;
+                size_t count = lane.start.size();
+
+                // max_end is non-decreasing, so every event before this one ends before the view.
+                size_t i = std::upper_bound(lane.max_end.begin(), lane.max_end.end(), m_view_begin) - lane.max_end.begin();
+                while (i < count && lane.start[i] < m_view_end)
+                {
+                    float x0 = left + (float)((lane.start[i] - m_view_begin) * scale);
+                    float x1 = left + (float)((lane.end[i] - m_view_begin) * scale);
+                    if (x1 - x0 >= m_min_width)
+                    {
+                        ImVec2 min(std::max(x0, left), y0);
+                        ImVec2 max(std::min(x1, right), y1);
+                        draw_list->AddRectFilled(min, max, label_color(lane.label[i]));
+                        if (max.x - min.x > font_size * 2.0f && lane.label[i] < m_labels.size())
+                        {
+                            const std::string& text = m_labels[lane.label[i]];
+                            ImVec4 clip(min.x + 2.0f, min.y, max.x - 2.0f, max.y);
+                            draw_list->AddText(font, font_size, ImVec2(min.x + 2.0f, y0 + (y1 - y0 - font_size) * 0.5f), IM_COL32_BLACK,
+                                text.data(), text.data() + text.size(), 0.0f, &clip);
+                        }
+                        if (mouse_in_lane && io.MousePos.x >= min.x && io.MousePos.x < max.x)
+                        {
+                            hovered_lane = lane_index;
+                            hovered_event = i;
+                        }
+                        i++;
+                        continue;
+                    }
+
+                    // Sub-pixel event: merge everything starting in the same pixel column into one bar.
+                    float column = std::floor(x0);
+                    double column_end = m_view_begin + (column + 1.0f - left) / scale;
+                    size_t next = std::lower_bound(lane.start.begin() + i + 1, lane.start.end(), column_end) - lane.start.begin();
+                    float bar_end = column + 1.0f;
+                    if (i == 0 || lane.max_end[next - 1] > lane.max_end[i - 1])
+                        bar_end = std::max(bar_end, left + (float)((lane.max_end[next - 1] - m_view_begin) * scale));
+                    draw_list->AddRectFilled(ImVec2(std::max(column, left), y0), ImVec2(std::min(bar_end, right), y1), IM_COL32(128, 128, 128, 255));
+                    i = next;
+                }
+            }
+
+        public:
+            Timeline(const std::string& name)
+                : m_name(name)
+            {
+            }
+
+            size_t add_lane(const std::string& name)
+            {
+                m_lanes.emplace_back();
+                m_lanes.back().name = name;
+                mark_changed();
+                return m_lanes.size() - 1;
+            }
+
+            uint32_t add_label(const std::string& label)
+            {
+                m_labels.push_back(label);
+                return (uint32_t)(m_labels.size() - 1);
+            }
+
+            // Appending in start order is O(1); out of order events trigger one sort of the lane
+            // on the next update.
+            Timeline& add_event(size_t lane, double start, double end, uint32_t label)
+            {
+                Lane& target = m_lanes[lane];
+                if (!target.start.empty() && start < target.start.back())
+                    target.sorted = false;
+                double max_end = target.max_end.empty() ? end : std::max(target.max_end.back(), end);
+                target.start.push_back(start);
+                target.end.push_back(end);
+                target.max_end.push_back(max_end);
+                target.label.push_back(label);
+                mark_changed();
+                return *this;
+            }
+
+            Timeline& clear()
+            {
+                m_lanes.clear();
+                m_labels.clear();
+                mark_changed();
+                return *this;
+            }
+
+            // Visible events are found by binary search and events narrower than a pixel are merged
+            // into one bar per pixel column, so the cost per lane is bounded by the width in pixels.
+            virtual void update() override
+            {
+                float lane_height = m_lane_height > 0.0f ? m_lane_height : ImGui::GetFrameHeight();
+                float width = std::max(ImGui::GetContentRegionAvail().x, m_lane_name_width + 1.0f);
+                float height = m_height > 0.0f ? m_height : lane_height * m_lanes.size();
+                ImVec2 origin = ImGui::GetCursorScreenPos();
+                float left = origin.x + m_lane_name_width;
+                float right = origin.x + width;
+
+                ImGui::InvisibleButton(m_name.c_str(), ImVec2(width, std::max(height, 1.0f)));
+                bool hovered = ImGui::IsItemHovered();
+                const ImGuiIO& io = ImGui::GetIO();
+                double scale = (right - left) / std::max(m_view_end - m_view_begin, 1e-12);
+
+                if (hovered && io.MouseWheel != 0.0f)
+                {
+                    double pivot = m_view_begin + (io.MousePos.x - left) / scale;
+                    double factor = std::pow(0.8, (double)io.MouseWheel);
+                    m_view_begin = pivot - (pivot - m_view_begin) * factor;
+                    m_view_end = pivot + (m_view_end - pivot) * factor;
+                }
+                if (ImGui::IsItemActive() && ImGui::IsMouseDragging(ImGuiMouseButton_Left))
+                {
+                    double delta = io.MouseDelta.x / scale;
+                    m_view_begin -= delta;
+                    m_view_end -= delta;
+                }
+                if (hovered && ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left))
+                    fit();
+                scale = (right - left) / std::max(m_view_end - m_view_begin, 1e-12);
+
+                ImDrawList *draw_list = ImGui::GetWindowDrawList();
+                float clip_top = std::max(draw_list->GetClipRectMin().y, origin.y);
+                float clip_bottom = std::min(draw_list->GetClipRectMax().y, origin.y + height);
+                size_t first_lane = (size_t)std::max(0.0f, (clip_top - origin.y) / lane_height);
+                size_t last_lane = std::min(m_lanes.size(), (size_t)std::max(0.0f, (clip_bottom - origin.y) / lane_height + 1));
+                size_t hovered_lane = SIZE_MAX;
+                size_t hovered_event = SIZE_MAX;
+                ImU32 text_color = ImGui::GetColorU32(ImGuiCol_Text);
+
+                draw_list->PushClipRect(origin, ImVec2(right, origin.y + height), true);
+                for (size_t lane = first_lane; lane < last_lane; lane++)
+                {
+                    float y0 = origin.y + lane * lane_height;
+                    float y1 = y0 + lane_height - 1.0f;
+                    const std::string& name = m_lanes[lane].name;
+                    ImVec4 clip(origin.x, y0, left - 4.0f, y1);
+                    draw_list->AddText(ImGui::GetFont(), ImGui::GetFontSize(), ImVec2(origin.x, y0 + (lane_height - ImGui::GetFontSize()) * 0.5f), text_color,
+                        name.data(), name.data() + name.size(), 0.0f, &clip);
+
+                    draw_list->PushClipRect(ImVec2(left, y0), ImVec2(right, y1 + 1.0f), true);
+                    draw_lane(draw_list, m_lanes[lane], left, right, y0, y1, scale, hovered_lane, hovered_event, lane);
+                    draw_list->PopClipRect();
+                }
+                draw_list->PopClipRect();
+
+                if (hovered && hovered_event != SIZE_MAX)
+                {
+                    const Lane& lane = m_lanes[hovered_lane];
+                    uint32_t label = lane.label[hovered_event];
+                    ImGui::SetTooltip("%s\n%s\nstart: %.6f\nduration: %.6f", lane.name.c_str(), label < m_labels.size() ? m_labels[label].c_str() : "",
+                        lane.start[hovered_event], lane.end[hovered_event] - lane.start[hovered_event]);
+                }
+            }
+
+            Timeline& set_view(double begin, double end)
+            {
+                m_view_begin = begin;
+                m_view_end = end;
+                return *this;
+            }
+
+            // Shows every event.
+            Timeline& fit()
+            {
+                double begin = DBL_MAX;
+                double end = -DBL_MAX;
+                for (auto& lane : m_lanes)
+                {
+                    if (lane.start.empty())
+                        continue;
+                    begin = std::min(begin, lane.sorted ? lane.start.front() : *std::min_element(lane.start.begin(), lane.start.end()));
+                    end = std::max(end, lane.max_end.back());
+                }
+                if (begin < end)
+                    set_view(begin, end);
+                return *this;
+            }
+
+            Timeline& set_name(const std::string& name)
+            {
+                m_name = name;
+                return *this;
+            }
+
+            // 0 uses the frame height.
+            Timeline& set_lane_height(float lane_height)
+            {
+                m_lane_height = lane_height;
+                return *this;
+            }
+
+            Timeline& set_lane_name_width(float lane_name_width)
+            {
+                m_lane_name_width = lane_name_width;
+                return *this;
+            }
+
+            // 0 fits every lane.
+            Timeline& set_height(float height)
+            {
+                m_height = height;
+                return *this;
+            }
+
+            // See ThreadPool::parallel_sort_on().
+            Timeline& set_thread_pool(ThreadPool *pool)
+            {
+                m_pool = pool;
+                return *this;
+            }
+
+            size_t get_lane_count() const
+            {
+                return m_lanes.size();
+            }
+
+            size_t get_event_count(size_t lane) const
+            {
+                return m_lanes[lane].start.size();
+            }
+
+            virtual size_t trim(float max_slack) override
+            {
+                size_t released = MemoryTrim::shrink(m_lanes, max_slack) + MemoryTrim::shrink(m_labels, max_slack);
+                for (Lane& lane : m_lanes)
+                {
+                    released += MemoryTrim::shrink(lane.start, max_slack) + MemoryTrim::shrink(lane.end, max_slack)
+                        + MemoryTrim::shrink(lane.max_end, max_slack) + MemoryTrim::shrink(lane.label, max_slack);
+                }
+                return released;
+            }
+
+            virtual void report_memory(MemoryReport& report) const override
+            {
+                size_t bytes = MemoryReport::bytes_of(m_name) + MemoryReport::bytes_of(m_lanes) + MemoryReport::bytes_of(m_labels);
+                for (const Lane& lane : m_lanes)
+                {
+                    bytes += MemoryReport::bytes_of(lane.name) + MemoryReport::bytes_of(lane.start) + MemoryReport::bytes_of(lane.end)
+                        + MemoryReport::bytes_of(lane.max_end) + MemoryReport::bytes_of(lane.label);
+                }
+                report.add(bytes);
+            }
+
+            virtual const std::string& get_name() const override
+            {
+                return m_name;
+            }
+        };
+
+        using GuiTimeline = Ref<Timeline>;
+        using GuiTimelinePtr = Timeline *;
+
+        class PerfOverlay : public Object
+        {
+        private:
+            PlotLines m_frame_times;
+            float m_max_frame_time = 1.0f / 30.0f;
+            uint64_t m_last_index = 0;
+            char m_overlay_text[32] = "";
+            std::unordered_map<const std::type_info *, std::string> m_type_names;
+
+            const std::string& type_name(const std::type_info& type)
+            {
+                auto it = m_type_names.find(&type);
+                if (it == m_type_names.end())
+                    it = m_type_names.emplace(&type, Trace::type_name(type)).first;
+                return it->second;
+            }
+
+        public:
+            // Per-widget timing stays enabled while at least one overlay exists.
+            PerfOverlay(size_t history = 240)
+                : m_frame_times("##frame_time", std::vector<float>(std::max<size_t>(history, 1), 0.0f))
+            {
+                m_frame_times.set_scale_min(0.0f).set_graph_size(ImVec2(0, 60));
+                Metrics::set_enabled(true);
+            }
+
+            PerfOverlay(const PerfOverlay&) = delete;
+            PerfOverlay& operator=(const PerfOverlay&) = delete;
+
+            ~PerfOverlay()
+            {
+                Metrics::set_enabled(false);
+            }
+
+            virtual void update() override
+            {
+                const Metrics::Frame& frame = Metrics::get_last_frame();
+                if (frame.index != m_last_index)
+                {
+                    m_last_index = frame.index;
+                    float milliseconds = frame.frame_time * 1000.0f;
+                    m_max_frame_time = std::max(m_max_frame_time * 0.995f, milliseconds);
+                    snprintf(m_overlay_text, sizeof(m_overlay_text), "%.2f ms", milliseconds);
+                    m_frame_times.push_value(milliseconds)
+                        .set_overlay_text(m_overlay_text)
+                        .set_scale_max(m_max_frame_time * 1.1f);
+                }
+                m_frame_times.update();
+
+                ImGui::Text("Widgets: %llu updated, %llu culled", (unsigned long long)frame.widgets, (unsigned long long)frame.culled);
+                if (Metrics::counts_allocations())
+                    ImGui::Text("Allocations: %llu", (unsigned long long)frame.allocations);
+                else
+                    ImGui::TextDisabled("Allocations: define EASYDEAR_COUNT_ALLOCATIONS");
+
+                ImGui::Separator();
+                for (size_t i = 0; i < frame.slowest_count; i++)
+                {
+                    const Metrics::WidgetCost& cost = frame.slowest[i];
+                    ImGui::Text("%8.3f ms  %s", cost.nanoseconds / 1e6, cost.name[0] ? cost.name : type_name(*cost.type).c_str());
+                }
+            }
+
+            virtual size_t trim(float max_slack) override
+            {
+                return m_frame_times.trim(max_slack);
+            }
+
+            virtual void report_memory(MemoryReport& report) const override
+            {
+                m_frame_times.report_memory(report);
+            }
+        };
+
+        using GuiPerfOverlay = Ref<PerfOverlay>;
+        using GuiPerfOverlayPtr = PerfOverlay *;
+
+        // A small auto-sized window showing the previous frame's metrics.
+        inline GuiWindow make_perf_overlay(const std::string& name = "Performance", size_t history = 240)
+        {
+            GuiWindow window = make_gui<Window>(name, true, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav);
+            window->add_object(make_gui<PerfOverlay>(history));
+            return window;
+        }
+
+        // Lists where the memory of a set of windows goes: totals per widget type and the widgets
+        // owning the most heap memory themselves. Walking the trees is done on refresh only.
+        class MemoryView : public Object
+        {
+        private:
+            struct Row
+            {
+                std::string type;
+                std::string name;
+                std::string window;
+                size_t count;
+                size_t self_bytes;
+                size_t total_bytes;
+                uint32_t callbacks;
+            };
+
+#if EASYDEAR_OWNERSHIP == EASYDEAR_OWNERSHIP_INTRUSIVE
+            using WindowRef = IntrusivePtr<const Window>;
+#elif EASYDEAR_OWNERSHIP == EASYDEAR_OWNERSHIP_UNIQUE
+            // The owner of the unique Ref must keep the window alive as long as the view.
+            using WindowRef = const Window *;
+#else
+            // Observed only: a window released elsewhere drops out at the next refresh.
+            using WindowRef = std::weak_ptr<const Window>;
+#endif
+
+            std::string m_name;
+            std::vector<WindowRef> m_windows;
+            MemoryReport m_report;
+            std::vector<Row> m_types;
+            std::vector<Row> m_largest;
+            size_t m_total_bytes = 0;
+            size_t m_max_rows = 50;
+            double m_refresh_interval = 0.0;
+            double m_last_refresh = -1.0;
+
+            static const char *format_bytes(size_t bytes, char (&buffer)[32])
+            {
+                if (bytes >= (1u << 30))
+                    snprintf(buffer, sizeof(buffer), "%.2f GB", bytes / (double)(1u << 30));
+                else if (bytes >= (1u << 20))
+                    snprintf(buffer, sizeof(buffer), "%.2f MB", bytes / (double)(1u << 20));
+                else if (bytes >= (1u << 10))
+                    snprintf(buffer, sizeof(buffer), "%.1f KB", bytes / 1024.0);
+                else
+                    snprintf(buffer, sizeof(buffer), "%zu B", bytes);
+                return buffer;
+            }
+
+            void refresh()
+            {
+                m_report.clear();
+#if EASYDEAR_OWNERSHIP == EASYDEAR_OWNERSHIP_SHARED
+                m_windows.erase(std::remove_if(m_windows.begin(), m_windows.end(), [](const WindowRef& window) {
+                    return window.expired();
+                }), m_windows.end());
+                for (const WindowRef& handle : m_windows)
+                {
+                    if (std::shared_ptr<const Window> window = handle.lock())
+                        window->report_memory(m_report);
+                }
+#else
+                for (const WindowRef& window : m_windows)
+                {
+                    window->report_memory(m_report);
+                }
+#endif
+                m_total_bytes = m_report.get_total_bytes();
+
+                m_types.clear();
+                for (const MemoryReport::TypeTotal& total : m_report.get_type_totals())
+                {
+                    m_types.push_back({Trace::type_name(*total.type), "", "", total.count, total.bytes, total.bytes, total.callbacks});
+                }
+
+                const std::vector<MemoryReport::Widget>& widgets = m_report.get_widgets();
+                std::vector<uint32_t> order(widgets.size());
+                std::vector<uint32_t> roots(widgets.size());
+                uint32_t root = 0;
+                for (uint32_t i = 0; i < widgets.size(); i++)
+                {
+                    if (widgets[i].depth == 0)
+                        root = i;
+                    order[i] = i;
+                    roots[i] = root;
+                }
+                size_t count = std::min(m_max_rows, order.size());
+                std::partial_sort(order.begin(), order.begin() + count, order.end(), [&widgets](uint32_t lhs, uint32_t rhs) {
+                    return widgets[lhs].self_bytes > widgets[rhs].self_bytes;
+                });
+                m_largest.clear();
+                for (size_t i = 0; i < count; i++)
+                {
+                    const MemoryReport::Widget& widget = widgets[order[i]];
+                    m_largest.push_back({Trace::type_name(*widget.type), widget.name, widgets[roots[order[i]]].name, 1, widget.self_bytes, widget.total_bytes, widget.callbacks});
+                }
+                m_last_refresh = ImGui::GetTime();
+            }
+
+            void rows_table(const char *id, const std::vector<Row>& rows, bool per_widget)
+            {
+                ImGuiTableFlags flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable;
+                if (!ImGui::BeginTable(id, 5, flags))
+                    return;
+                ImGui::TableSetupColumn("Type");
+                ImGui::TableSetupColumn(per_widget ? "Widget" : "Count");
+                ImGui::TableSetupColumn(per_widget ? "Self" : "Bytes");
+                ImGui::TableSetupColumn(per_widget ? "Total" : "Share");
+                ImGui::TableSetupColumn("Callbacks");
+                ImGui::TableHeadersRow();
+                char buffer[32];
+                for (const Row& row : rows)
+                {
+                    ImGui::TableNextRow();
+                    ImGui::TableSetColumnIndex(0);
+                    ImGui::TextUnformatted(row.type.c_str());
+                    ImGui::TableSetColumnIndex(1);
+                    if (per_widget)
+                        ImGui::Text("%s / %s", row.window.c_str(), row.name.c_str());
+                    else
+                        ImGui::Text("%zu", row.count);
+                    ImGui::TableSetColumnIndex(2);
+                    ImGui::TextUnformatted(format_bytes(row.self_bytes, buffer));
+                    ImGui::TableSetColumnIndex(3);
+                    if (per_widget)
+                        ImGui::TextUnformatted(format_bytes(row.total_bytes, buffer));
+                    else
+                        ImGui::Text("%.1f%%", m_total_bytes ? row.self_bytes * 100.0 / m_total_bytes : 0.0);
+                    ImGui::TableSetColumnIndex(4);
+                    ImGui::Text("%u", row.callbacks);
+                }
+                ImGui::EndTable();
+            }
+
+        public:
+            MemoryView(const std::string& name = "Memory")
+                : m_name(name)
+            {
+            }
+
+            MemoryView& add_window(const GuiWindow& window)
+            {
+#if EASYDEAR_OWNERSHIP == EASYDEAR_OWNERSHIP_UNIQUE
+                m_windows.push_back(window.get());
+#else
+                m_windows.push_back(WindowRef(window));
+#endif
+                m_last_refresh = -1.0;
+                return *this;
+            }
+
+            // Seconds between automatic refreshes; 0 refreshes on demand only.
+            MemoryView& set_refresh_interval(double refresh_interval)
+            {
+                m_refresh_interval = refresh_interval;
+                return *this;
+            }
+
+            MemoryView& set_max_rows(size_t max_rows)
+            {
+                m_max_rows = max_rows;
+                m_last_refresh = -1.0;
+                return *this;
+            }
+
+            const MemoryReport& get_report() const
+            {
+                return m_report;
+            }
+
+            virtual void update() override
+            {
+                ImGui::PushID(this);
+                bool expired = m_refresh_interval > 0.0 && ImGui::GetTime() - m_last_refresh >= m_refresh_interval;
+                if (ImGui::Button("Refresh") || m_last_refresh < 0.0 || expired)
+                    refresh();
+                char buffer[32];
+                ImGui::SameLine();
+                ImGui::Text("%s in %zu widgets", format_bytes(m_total_bytes, buffer), m_report.get_widgets().size());
+
+                ImGui::Separator();
+                ImGui::TextDisabled("By type");
+                rows_table("##types", m_types, false);
+                ImGui::TextDisabled("Largest widgets");
+                rows_table("##largest", m_largest, true);
+                ImGui::PopID();
+            }
+
+            virtual void report_memory(MemoryReport& report) const override
+            {
+                size_t bytes = MemoryReport::bytes_of(m_name) + MemoryReport::bytes_of(m_windows) + m_report.get_memory_bytes()
+                    + MemoryReport::bytes_of(m_types) + MemoryReport::bytes_of(m_largest);
+                for (const std::vector<Row> *rows : {&m_types, &m_largest})
+                {
+                    for (const Row& row : *rows)
+                    {
+                        bytes += MemoryReport::bytes_of(row.type) + MemoryReport::bytes_of(row.name) + MemoryReport::bytes_of(row.window);
+                    }
+                }
+                report.add(bytes);
+            }
+
+            virtual const std::string& get_name() const override
+            {
+                return m_name;
+            }
+        };
+
+        using GuiMemoryView = Ref<MemoryView>;
+        using GuiMemoryViewPtr = MemoryView *;
+
+        // Hex and ASCII dump of a memory-mapped file or a caller-owned buffer. Only the visible rows
+        // are formatted, into one reused buffer drawn with a single text call, and scrolling works
+        // in whole rows so multi-gigabyte files keep exact positions. Searches run on the pool.
+        class HexView : public Object
+        {
+        private:
+            struct Search
+            {
+                std::atomic<bool> cancelled{false};
+                std::atomic<bool> finished{false};
+                std::atomic<uint64_t> progress{0};
+                std::atomic<uint64_t> result{UINT64_MAX};
+            };
+
+            static constexpr size_t BYTES_PER_ROW = 16;
+
+            std::string m_name;
+            const uint8_t *m_data = nullptr;
+            uint64_t m_data_size = 0;
+            void *m_mapping = nullptr;
+            size_t m_mapping_size = 0;
+            uint64_t m_top_row = 0;
+            uint64_t m_cursor = UINT64_MAX;
+            uint64_t m_cursor_size = 0;
+            int m_offset_digits = 8;
+            std::vector<char> m_buffer;
+            char m_goto_text[20] = "";
+            char m_find_text[256] = "";
+            std::shared_ptr<Search> m_search;
+            std::future<void> m_search_done;
+            bool m_not_found = false;
+            ImVec2 m_size = ImVec2(0, 0);
+
+            static const char *hex_digits()
+            {
+                return "0123456789ABCDEF";
+            }
+
+            // Writes the two hex digits of 16 bytes, most significant nibble first.
+            static void hex_pairs(const uint8_t *bytes, char *out)
+            {
+#ifdef EASYDEAR_HAS_SSE2
+                __m128i value = _mm_loadu_si128((const __m128i *)bytes);
+                __m128i nibble = _mm_set1_epi8(0x0F);
+                __m128i high = _mm_and_si128(_mm_srli_epi16(value, 4), nibble);
+                __m128i low = _mm_and_si128(value, nibble);
+                __m128i nine = _mm_set1_epi8(9);
+                __m128i zero = _mm_set1_epi8('0');
+                __m128i letter = _mm_set1_epi8('A' - '0' - 10);
+                high = _mm_add_epi8(_mm_add_epi8(high, zero), _mm_and_si128(_mm_cmpgt_epi8(high, nine), letter));
+                low = _mm_add_epi8(_mm_add_epi8(low, zero), _mm_and_si128(_mm_cmpgt_epi8(low, nine), letter));
+                _mm_storeu_si128((__m128i *)out, _mm_unpacklo_epi8(high, low));
+                _mm_storeu_si128((__m128i *)(out + 16), _mm_unpackhi_epi8(high, low));
+#else
+                for (size_t i = 0; i < BYTES_PER_ROW; i++)
+                {
+                    out[i * 2] = hex_digits()[bytes[i] >> 4];
+                    out[i * 2 + 1] = hex_digits()[bytes[i] & 0x0F];
+                }
+#endif
+            }
+
+            // Printable ASCII is kept, everything else becomes '.'.
+            static void ascii_row(const uint8_t *bytes, char *out)
+            {
+#ifdef EASYDEAR_HAS_SSE2
+                __m128i value = _mm_loadu_si128((const __m128i *)bytes);
+                __m128i printable = _mm_and_si128(_mm_cmpgt_epi8(value, _mm_set1_epi8(0x1F)), _mm_cmplt_epi8(value, _mm_set1_epi8(0x7F)));
+                __m128i result = _mm_or_si128(_mm_and_si128(printable, value), _mm_andnot_si128(printable, _mm_set1_epi8('.')));
+                _mm_storeu_si128((__m128i *)out, result);
+#else
+                for (size_t i = 0; i < BYTES_PER_ROW; i++)
+                {
+                    out[i] = bytes[i] >= 0x20 && bytes[i] < 0x7F ? (char)bytes[i] : '.';
+                }
+#endif
+            }
+
+            size_t line_length() const
+            {
+                return (size_t)m_offset_digits + 2 + BYTES_PER_ROW * 3 + 1 + 1 + BYTES_PER_ROW + 1;
             }
 
-            Histogram& set_overlay_text(const std::string& overlay_text)
+            size_t hex_column(size_t byte) const
             {
-                m_overlay_text = overlay_text;
-                return *this;
+                return (size_t)m_offset_digits + 2 + byte * 3 + (byte >= BYTES_PER_ROW / 2 ? 1 : 0);
             }
 
-            Histogram& set_scale_min(float scale_min)
+            char *format_row(char *out, uint64_t row) const
             {
-                m_scale_min = scale_min;
-                return *this;
+                uint64_t offset = row * BYTES_PER_ROW;
+                for (int digit = m_offset_digits - 1; digit >= 0; digit--)
+                {
+                    *out++ = hex_digits()[(offset >> (digit * 4)) & 0x0F];
+                }
+                *out++ = ' ';
+                *out++ = ' ';
+
+                uint8_t bytes[BYTES_PER_ROW] = {};
+                size_t count = (size_t)std::min<uint64_t>(BYTES_PER_ROW, m_data_size - offset);
+                memcpy(bytes, m_data + offset, count);
+                char pairs[BYTES_PER_ROW * 2];
+                char ascii[BYTES_PER_ROW];
+                hex_pairs(bytes, pairs);
+                ascii_row(bytes, ascii);
+                for (size_t i = 0; i < BYTES_PER_ROW; i++)
+                {
+                    if (i == BYTES_PER_ROW / 2)
+                        *out++ = ' ';
+                    out[0] = i < count ? pairs[i * 2] : ' ';
+                    out[1] = i < count ? pairs[i * 2 + 1] : ' ';
+                    out[2] = ' ';
+                    out += 3;
+                }
+                *out++ = ' ';
+                memcpy(out, ascii, count);
+                memset(out + count, ' ', BYTES_PER_ROW - count);
+                out += BYTES_PER_ROW;
+                *out++ = '\n';
+                return out;
             }
 
-            Histogram& set_scale_max(float scale_max)
+            uint64_t get_row_count() const
             {
-                m_scale_max = scale_max;
-                return *this;
+                return (m_data_size + BYTES_PER_ROW - 1) / BYTES_PER_ROW;
             }
 
-            Histogram& set_graph_size(const ImVec2& graph_size)
+            void cancel_search()
             {
-                m_graph_size = graph_size;
-                return *this;
+                if (m_search)
+                    m_search->cancelled.store(true, std::memory_order_relaxed);
+                if (m_search_done.valid())
+                    m_search_done.wait();
+                m_search.reset();
+                m_search_done = std::future<void>();
             }
 
-            Histogram& set_stride(int stride)
+            void unmap()
             {
-                m_stride = stride;
-                return *this;
+                cancel_search();
+#ifdef EASYDEAR_HAS_MMAP
+                if (m_mapping != nullptr)
+                    munmap(m_mapping, m_mapping_size);
+#endif
+                m_mapping = nullptr;
+                m_mapping_size = 0;
+                m_data = nullptr;
+                m_data_size = 0;
             }
-        };
 
-        class Text : public Object
-        {
-        private:
-            std::string *m_text;
-            float rgba[4];
-        
-        public:
-            Text(std::string *text, float r, float g, float b, float a)
-                : m_text(text)
+            // "DE AD be ef" searches for bytes; anything but pairs of hex digits searches for the text.
+            static std::vector<uint8_t> parse_pattern(const char *text)
             {
-                set_color(r, g, b, a);
+                size_t length = strlen(text);
+                std::string digits;
+                if (strspn(text, "0123456789abcdefABCDEF ") == length)
+                {
+                    for (size_t i = 0; i < length; i++)
+                    {
+                        if (text[i] != ' ')
+                            digits += text[i];
+                    }
+                }
+                if (digits.empty() || digits.size() % 2 != 0)
+                    return std::vector<uint8_t>(text, text + length);
+
+                std::vector<uint8_t> pattern;
+                for (size_t i = 0; i < digits.size(); i += 2)
+                {
+                    pattern.push_back((uint8_t)strtoul(digits.substr(i, 2).c_str(), nullptr, 16));
+                }
+                return pattern;
             }
 
-            virtual void update() override
+            void poll_search()
             {
-                ImGui::TextUnformatted(m_text->c_str());
+                if (!m_search || !m_search->finished.load(std::memory_order_acquire))
+                    return;
+                uint64_t result = m_search->result.load(std::memory_order_relaxed);
+                m_not_found = result == UINT64_MAX;
+                if (!m_not_found)
+                    select(result, m_cursor_size);
+                m_search.reset();
+                m_search_done = std::future<void>();
             }
 
-            Text& set_text(std::string* text)
+            void draw_toolbar()
             {
-                m_text = text;
-                return *this;
+                ImGui::SetNextItemWidth(ImGui::CalcTextSize("0000000000000000").x + ImGui::GetStyle().FramePadding.x * 2);
+                if (ImGui::InputText("Go to", m_goto_text, sizeof(m_goto_text), ImGuiInputTextFlags_CharsHexadecimal | ImGuiInputTextFlags_EnterReturnsTrue))
+                    goto_offset(strtoull(m_goto_text, nullptr, 16));
+                ImGui::SameLine();
+                ImGui::SetNextItemWidth(ImGui::GetFontSize() * 16);
+                bool find = ImGui::InputText("##find", m_find_text, sizeof(m_find_text), ImGuiInputTextFlags_EnterReturnsTrue);
+                ImGui::SameLine();
+                find |= ImGui::Button(is_searching() ? "Cancel" : "Find next");
+                if (find && is_searching())
+                    cancel_search();
+                else if (find && m_find_text[0] != '\0')
+                    this->find(parse_pattern(m_find_text), m_cursor == UINT64_MAX ? 0 : m_cursor + 1);
+                ImGui::SameLine();
+                if (m_search)
+                    ImGui::Text("Searching... %.0f%%", m_data_size ? m_search->progress.load(std::memory_order_relaxed) * 100.0 / m_data_size : 0.0);
+                else if (m_not_found)
+                    ImGui::TextUnformatted("Not found");
+                else if (m_cursor != UINT64_MAX)
+                    ImGui::Text("Offset %llX", (unsigned long long)m_cursor);
             }
 
-            void set_color(float r, float g, float b, float a)
+        public:
+            HexView(const std::string& name)
+                : m_name(name)
             {
-                rgba[0] = r;
-                rgba[1] = g;
-                rgba[2] = b;
-                rgba[3] = a;
             }
 
-            float *get_color()
+            ~HexView()
             {
-                return rgba;
+                unmap();
             }
-        };
 
-        using GuiText = std::shared_ptr<Text>;
-        using GuiTextPtr = Text *;
+            HexView(const HexView&) = delete;
+            HexView& operator=(const HexView&) = delete;
 
-        class Logger : public Object
-        {
-        private:
-            size_t m_max_lines = 0;
-            std::vector<GuiText> m_lines;
-            float rgba[4];
+#ifdef EASYDEAR_HAS_MMAP
+            // Maps the whole file read-only; pages are read lazily as rows become visible.
+            bool open(const std::string& path)
+            {
+                unmap();
+                int fd = ::open(path.c_str(), O_RDONLY);
+                if (fd < 0)
+                    return false;
+                struct stat info;
+                if (fstat(fd, &info) != 0)
+                {
+                    ::close(fd);
+                    return false;
+                }
+                void *mapping = nullptr;
+                if (info.st_size > 0)
+                {
+                    mapping = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (mapping == MAP_FAILED)
+                    {
+                        ::close(fd);
+                        return false;
+                    }
+                }
+                ::close(fd);
+                m_mapping = mapping;
+                m_mapping_size = (size_t)info.st_size;
+                set_view((const uint8_t *)mapping, (uint64_t)info.st_size);
+                return true;
+            }
+#endif
 
-        public:
-            Logger(float r, float g, float b, float a)
+            // Shows memory owned by the caller, which must outlive the view or the next set_data().
+            HexView& set_data(const uint8_t *data, uint64_t size)
             {
-                set_color(r, g, b, a);
+                unmap();
+                set_view(data, size);
+                return *this;
             }
 
-            Logger& set_color(float r, float g, float b, float a)
+            void set_view(const uint8_t *data, uint64_t size)
             {
-                rgba[0] = r;
-                rgba[1] = g;
-                rgba[2] = b;
-                rgba[3] = a;
-                for (auto& line : m_lines)
+                m_data = data;
+                m_data_size = size;
+                m_top_row = 0;
+                m_cursor = UINT64_MAX;
+                m_cursor_size = 0;
+                m_not_found = false;
+                m_offset_digits = 8;
+                while (m_offset_digits < 16 && (size >> (m_offset_digits * 4)) != 0)
                 {
-                    line->set_color(r, g, b, a);
+                    m_offset_digits++;
                 }
+            }
+
+            HexView& close()
+            {
+                unmap();
                 return *this;
             }
 
-            Logger& set_max_lines(size_t max_lines)
+            HexView& set_size(const ImVec2& size)
             {
-                m_max_lines = max_lines;
+                m_size = size;
                 return *this;
             }
 
-            Logger& add_text(const std::string& text)
+            HexView& goto_offset(uint64_t offset)
             {
-                auto stext = std::make_shared<Text>(new std::string(text), rgba[0], rgba[1], rgba[2], rgba[3]);
-                m_lines.push_back(stext);
-                if (m_max_lines != 0 && m_lines.size() > m_max_lines)
-                {
-                    m_lines.erase(m_lines.begin());
-                }
+                if (m_data_size != 0)
+                    m_top_row = std::min(offset, m_data_size - 1) / BYTES_PER_ROW;
                 return *this;
             }
 
-            virtual void update() override
+            HexView& select(uint64_t offset, uint64_t size = 1)
             {
-                for (auto& line : m_lines)
-                {
-                    line->update();
-                }
+                m_cursor = offset;
+                m_cursor_size = size;
+                return goto_offset(offset);
             }
-        };
-        
-        using GuiLogger = std::shared_ptr<Logger>;
-        using GuiLoggerPtr = Logger *;
 
-        class Button : public Object
-        {
-        private:
-            std::string m_name;
-            std::function<void()> m_callback;
+            // Looks for pattern from offset on the thread pool; the match is selected when found.
+            HexView& find(std::vector<uint8_t> pattern, uint64_t from = 0)
+            {
+                cancel_search();
+                m_not_found = false;
+                if (pattern.empty() || m_data == nullptr)
+                    return *this;
+                std::shared_ptr<Search> search = std::make_shared<Search>();
+                m_search = search;
+                m_cursor_size = pattern.size();
+                const uint8_t *data = m_data;
+                uint64_t size = m_data_size;
+                m_search_done = ThreadPool::instance().submit([search, data, size, from, pattern = std::move(pattern)] {
+                    const uint8_t *position = data + std::min(from, size);
+                    const uint8_t *end = data + size;
+                    while ((uint64_t)(end - position) >= pattern.size() && !search->cancelled.load(std::memory_order_relaxed))
+                    {
+                        const uint8_t *chunk_end = position + std::min<uint64_t>(end - position, 1 << 20);
+                        const uint8_t *hit = (const uint8_t *)memchr(position, pattern[0], chunk_end - position);
+                        if (hit == nullptr)
+                        {
+                            position = chunk_end;
+                            search->progress.store(position - data, std::memory_order_relaxed);
+                            continue;
+                        }
+                        if ((uint64_t)(end - hit) >= pattern.size() && memcmp(hit, pattern.data(), pattern.size()) == 0)
+                        {
+                            search->result.store(hit - data, std::memory_order_relaxed);
+                            break;
+                        }
+                        position = hit + 1;
+                    }
+                    search->finished.store(true, std::memory_order_release);
+                });
+                return *this;
+            }
 
-        public:
-            Button(const std::string& name, const std::function<void()>& callback)
-                : m_name(name), m_callback(callback)
+            bool is_searching() const
+            {
+                return m_search != nullptr;
+            }
+
+            uint64_t get_cursor() const
             {
+                return m_cursor;
+            }
+
+            uint64_t get_data_size() const
+            {
+                return m_data_size;
             }
 
             virtual void update() override
             {
-                if (ImGui::Button(m_name.c_str()))
+                poll_search();
+                ImGui::PushID(this);
+                draw_toolbar();
+
+                DrawCache::note_window();
+                ImGui::BeginChild(m_name.c_str(), m_size, true, ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoScrollWithMouse);
+                float line_height = ImGui::GetTextLineHeight();
+                float scrollbar_width = ImGui::GetStyle().ScrollbarSize;
+                ImVec2 available = ImGui::GetContentRegionAvail();
+                uint64_t visible_rows = (uint64_t)std::max(1.0f, std::floor(available.y / line_height));
+                uint64_t row_count = get_row_count();
+                uint64_t max_top = row_count > visible_rows ? row_count - visible_rows : 0;
+
+                if (ImGui::IsWindowHovered())
                 {
-                    m_callback();
+                    float wheel = ImGui::GetIO().MouseWheel;
+                    if (wheel > 0.0f)
+                        m_top_row -= std::min<uint64_t>(m_top_row, (uint64_t)(wheel * 3));
+                    else if (wheel < 0.0f)
+                        m_top_row += (uint64_t)(-wheel * 3);
+                }
+                if (ImGui::IsWindowFocused())
+                {
+                    if (ImGui::IsKeyPressed(ImGuiKey_PageUp))
+                        m_top_row -= std::min(m_top_row, visible_rows);
+                    if (ImGui::IsKeyPressed(ImGuiKey_PageDown))
+                        m_top_row += visible_rows;
+                    if (ImGui::IsKeyPressed(ImGuiKey_Home))
+                        m_top_row = 0;
+                    if (ImGui::IsKeyPressed(ImGuiKey_End))
+                        m_top_row = max_top;
+                }
+                m_top_row = std::min(m_top_row, max_top);
+
+                uint64_t rows = std::min<uint64_t>(visible_rows, row_count - m_top_row);
+                m_buffer.resize((size_t)rows * line_length());
+                char *end = m_buffer.data();
+                for (uint64_t row = 0; row < rows; row++)
+                {
+                    end = format_row(end, m_top_row + row);
+                }
+
+                float content_x = ImGui::GetCursorPosX();
+                ImVec2 origin = ImGui::GetCursorScreenPos();
+                float char_width = ImGui::CalcTextSize("0").x;
+                if (m_cursor != UINT64_MAX && m_cursor_size != 0)
+                {
+                    ImDrawList *draw_list = ImGui::GetWindowDrawList();
+                    ImU32 color = ImGui::GetColorU32(ImGuiCol_TextSelectedBg);
+                    uint64_t first = std::max(m_cursor, m_top_row * BYTES_PER_ROW);
+                    uint64_t last = std::min(m_cursor + m_cursor_size, (m_top_row + rows) * BYTES_PER_ROW);
+                    for (uint64_t offset = first; offset < last; offset++)
+                    {
+                        float x = origin.x + char_width * hex_column(offset % BYTES_PER_ROW);
+                        float y = origin.y + line_height * (float)(offset / BYTES_PER_ROW - m_top_row);
+                        draw_list->AddRectFilled(ImVec2(x, y), ImVec2(x + char_width * 2, y + line_height), color);
+                    }
+                }
+                ImGui::TextUnformatted(m_buffer.data(), end);
+
+                if (ImGui::IsItemHovered() && ImGui::IsMouseClicked(0))
+                {
+                    ImVec2 mouse = ImGui::GetMousePos();
+                    uint64_t row = m_top_row + (uint64_t)((mouse.y - origin.y) / line_height);
+                    float column = (mouse.x - origin.x) / char_width - (m_offset_digits + 2);
+                    if (column >= BYTES_PER_ROW / 2 * 3)
+                        column -= 1;
+                    size_t byte = (size_t)std::max(0.0f, column / 3);
+                    if (byte < BYTES_PER_ROW && row * BYTES_PER_ROW + byte < m_data_size)
+                        select(row * BYTES_PER_ROW + byte);
+                }
+
+                if (max_top > 0)
+                {
+                    ImGui::SameLine(std::max(content_x + available.x - scrollbar_width, content_x + char_width * line_length()));
+                    uint64_t minimum = 0;
+                    uint64_t inverted = max_top - m_top_row;
+                    if (ImGui::VSliderScalar("##scroll", ImVec2(scrollbar_width, available.y), ImGuiDataType_U64, &inverted, &minimum, &max_top, ""))
+                        m_top_row = max_top - inverted;
                 }
+                ImGui::EndChild();
+                ImGui::PopID();
             }
 
-            Button& set_name(const std::string& name)
+            virtual void report_memory(MemoryReport& report) const override
             {
-                m_name = name;
-                return *this;
+                report.add(MemoryReport::bytes_of(m_name) + MemoryReport::bytes_of(m_buffer));
             }
 
-            Button& set_callback(const std::function<void()>& callback)
+            virtual size_t trim(float max_slack) override
             {
-                m_callback = callback;
-                return *this;
+                return MemoryTrim::shrink(m_buffer, max_slack);
             }
 
-            Button& set_callback(std::function<void()>&& callback)
+            virtual const std::string& get_name() const override
             {
-                m_callback = std::move(callback);
-                return *this;
+                return m_name;
             }
         };
 
-        using GuiButton = std::shared_ptr<Button>;
-        using GuiButtonPtr = Button *;
+        using GuiHexView = Ref<HexView>;
+        using GuiHexViewPtr = HexView *;
 
-        template <typename T>
-        class SliderT : public Object
+#ifdef __linux__
+        // CPU, resident memory and thread count of the current process, sampled on a background
+        // thread from /proc/self/stat and /proc/self/status kept open and re-read with pread().
+        // Samples go to fixed rings of atomics; plots decimate them to one min/max bar per pixel.
+        class ResourceMonitor : public Object
         {
+        public:
+            enum Series
+            {
+                Series_Cpu,
+                Series_Rss,
+                Series_Threads,
+                Series_Count
+            };
+
         private:
             std::string m_name;
-            T *m_value;
-            T m_min;
-            T m_max;
-            std::string m_format;
-            T m_power = 1.0f;
-        
-        public:
-            SliderT(const std::string& name, T *value, T min, T max)
-                : m_name(name), m_value(value), m_min(min), m_max(max)
+            size_t m_capacity;
+            std::unique_ptr<std::atomic<float>[]> m_samples[Series_Count];
+            std::atomic<uint64_t> m_count{0};
+            std::atomic<uint64_t> m_peak_rss{0};
+            std::atomic<double> m_interval;
+            int m_stat_fd = -1;
+            int m_status_fd = -1;
+            double m_ticks_per_second = 100.0;
+            float m_plot_height = 60.0f;
+
+            std::mutex m_mutex;
+            std::condition_variable m_wake;
+            bool m_stopping = false;
+            std::thread m_thread;
+
+            static ssize_t read_file(int fd, char *buffer, size_t size)
             {
-                if constexpr(std::is_same_v<T, float>)
+                ssize_t length = pread(fd, buffer, size - 1, 0);
+                buffer[length > 0 ? length : 0] = '\0';
+                return length;
+            }
+
+            static uint64_t status_field(const char *status, const char *name)
+            {
+                const char *field = strstr(status, name);
+                return field ? strtoull(field + strlen(name), nullptr, 10) : 0;
+            }
+
+            void sample(uint64_t& last_ticks, std::chrono::steady_clock::time_point& last_time)
+            {
+                char stat[1024];
+                char status[4096];
+                if (read_file(m_stat_fd, stat, sizeof(stat)) <= 0 || read_file(m_status_fd, status, sizeof(status)) <= 0)
+                    return;
+
+                // Fields after the parenthesised command name, starting with field 3 (state).
+                const char *cursor = strrchr(stat, ')');
+                if (cursor == nullptr || cursor[1] == '\0' || cursor[2] == '\0')
+                    return;
+                cursor += 3;
+                uint64_t fields[22] = {};
+                for (size_t field = 4; field < 22 && *cursor; field++)
                 {
-                    m_format = "%.3f";
+                    char *end;
+                    fields[field] = strtoull(cursor, &end, 10);
+                    cursor = end;
                 }
-                else
+                uint64_t ticks = fields[14] + fields[15];
+                auto now = std::chrono::steady_clock::now();
+                double elapsed = std::chrono::duration<double>(now - last_time).count();
+                float cpu = last_ticks != 0 && elapsed > 0.0 ? (float)((ticks - last_ticks) / m_ticks_per_second / elapsed * 100.0) : 0.0f;
+                last_ticks = ticks;
+                last_time = now;
+
+                uint64_t rss = status_field(status, "VmRSS:") * 1024;
+                uint64_t peak = status_field(status, "VmHWM:") * 1024;
+                m_peak_rss.store(std::max(peak, rss), std::memory_order_relaxed);
+
+                uint64_t index = m_count.load(std::memory_order_relaxed) % m_capacity;
+                m_samples[Series_Cpu][index].store(cpu, std::memory_order_relaxed);
+                m_samples[Series_Rss][index].store((float)rss, std::memory_order_relaxed);
+                m_samples[Series_Threads][index].store((float)fields[20], std::memory_order_relaxed);
+                m_count.fetch_add(1, std::memory_order_release);
+            }
+
+            void run()
+            {
+                uint64_t last_ticks = 0;
+                auto last_time = std::chrono::steady_clock::now();
+                std::unique_lock<std::mutex> lock(m_mutex);
+                while (!m_stopping)
                 {
-                    m_format = "%d";
+                    lock.unlock();
+                    sample(last_ticks, last_time);
+                    lock.lock();
+                    mark_changed();
+                    auto interval = std::chrono::duration<double>(m_interval.load(std::memory_order_relaxed));
+                    m_wake.wait_for(lock, interval, [this] { return m_stopping; });
                 }
             }
 
-            virtual void update() override
+            float get_sample(Series series, uint64_t count, size_t age) const
             {
-                if constexpr(std::is_same_v<T, float>)
+                return m_samples[series][(count - 1 - age) % m_capacity].load(std::memory_order_relaxed);
+            }
+
+            void plot(const char *label, Series series, float scale, const char *format)
+            {
+                uint64_t count = m_count.load(std::memory_order_acquire);
+                size_t samples = (size_t)std::min<uint64_t>(count, m_capacity);
+                ImVec2 size(std::max(ImGui::GetContentRegionAvail().x, 1.0f), m_plot_height);
+                ImVec2 origin = ImGui::GetCursorScreenPos();
+                ImGui::InvisibleButton(label, size);
+                ImDrawList *draw_list = ImGui::GetWindowDrawList();
+                draw_list->AddRectFilled(origin, ImVec2(origin.x + size.x, origin.y + size.y), ImGui::GetColorU32(ImGuiCol_FrameBg));
+                if (samples == 0)
+                    return;
+
+                float high = 0.0f;
+                for (size_t age = 0; age < samples; age++)
                 {
-                    ImGui::SliderFloat(m_name.c_str(), m_value, m_min, m_max, m_format.c_str(), m_power);
+                    high = std::max(high, get_sample(series, count, age));
                 }
-                else
+                high = high > 0.0f ? high * 1.1f : 1.0f;
+
+                // Newest sample on the right; each pixel column covers a run of samples, and fewer
+                // samples than pixels leave the left of the plot empty.
+                ImU32 color = ImGui::GetColorU32(ImGuiCol_PlotLines);
+                size_t columns = std::min(samples, std::max<size_t>((size_t)size.x, 1));
+                draw_list->PushClipRect(origin, ImVec2(origin.x + size.x, origin.y + size.y), true);
+                for (size_t column = 0; column < columns; column++)
                 {
-                    ImGui::SliderInt(m_name.c_str(), m_value, m_min, m_max, m_format.c_str(), m_power);
+                    size_t first = column * samples / columns;
+                    size_t last = (column + 1) * samples / columns;
+                    float minimum = FLT_MAX;
+                    float maximum = -FLT_MAX;
+                    for (size_t i = first; i < last; i++)
+                    {
+                        float value = get_sample(series, count, samples - 1 - i);
+                        minimum = std::min(minimum, value);
+                        maximum = std::max(maximum, value);
+                    }
+                    float x = origin.x + size.x - (float)(columns - column);
+                    float top = origin.y + size.y * (1.0f - maximum / high);
+                    float bottom = origin.y + size.y * (1.0f - minimum / high);
+                    draw_list->AddRectFilled(ImVec2(x, top), ImVec2(x + 1.0f, bottom + 1.0f), color);
                 }
+
+                char text[64];
+                snprintf(text, sizeof(text), format, get_sample(series, count, 0) * scale);
+                draw_list->AddText(ImVec2(origin.x + 4.0f, origin.y + 2.0f), ImGui::GetColorU32(ImGuiCol_Text), label);
+                ImVec2 text_size = ImGui::CalcTextSize(text);
+                draw_list->AddText(ImVec2(origin.x + size.x - text_size.x - 4.0f, origin.y + 2.0f), ImGui::GetColorU32(ImGuiCol_Text), text);
+                draw_list->PopClipRect();
             }
 
-            SliderT& set_name(const std::string& name)
+        public:
+            // history is the number of samples kept per series; interval is in seconds.
+            ResourceMonitor(const std::string& name, double interval = 0.5, size_t history = 600)
+                : m_name(name), m_capacity(std::max<size_t>(history, 1)), m_interval(interval)
             {
-                m_name = name;
-                return *this;
+                for (auto& samples : m_samples)
+                {
+                    samples.reset(new std::atomic<float>[m_capacity]);
+                    for (size_t i = 0; i < m_capacity; i++)
+                        samples[i].store(0.0f, std::memory_order_relaxed);
+                }
+                m_ticks_per_second = (double)sysconf(_SC_CLK_TCK);
+                m_stat_fd = ::open("/proc/self/stat", O_RDONLY | O_CLOEXEC);
+                m_status_fd = ::open("/proc/self/status", O_RDONLY | O_CLOEXEC);
+                if (m_stat_fd >= 0 && m_status_fd >= 0)
+                    m_thread = std::thread([this] { run(); });
             }
 
-            SliderT& set_value(const std::vector<T>& value)
+            ~ResourceMonitor()
             {
-                m_value = value;
-                return *this;
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_stopping = true;
+                }
+                m_wake.notify_all();
+                if (m_thread.joinable())
+                    m_thread.join();
+                if (m_stat_fd >= 0)
+                    ::close(m_stat_fd);
+                if (m_status_fd >= 0)
+                    ::close(m_status_fd);
             }
 
-            SliderT& set_min(T min)
+            ResourceMonitor(const ResourceMonitor&) = delete;
+            ResourceMonitor& operator=(const ResourceMonitor&) = delete;
+
+            ResourceMonitor& set_interval(double interval)
             {
-                m_min = min;
+                m_interval.store(interval, std::memory_order_relaxed);
+                m_wake.notify_all();
                 return *this;
             }
 
-            SliderT& set_max(SliderT max)
+            ResourceMonitor& set_plot_height(float plot_height)
             {
-                m_max = max;
+                m_plot_height = plot_height;
                 return *this;
             }
 
-            SliderT& set_format(const std::string& format)
+            // The sampling thread marks the widget changed under m_mutex.
+            virtual void attach(const std::shared_ptr<ChangeFlag>& flag) override
             {
-                m_format = format;
-                return *this;
+                std::lock_guard<std::mutex> lock(m_mutex);
+                Object::attach(flag);
             }
 
-            SliderT& set_power(T power)
+            bool is_sampling() const
             {
-                m_power = power;
-                return *this;
+                return m_thread.joinable();
             }
-        };
 
-        using SliderFloat = SliderT<float>;
-        using SliderInt = SliderT<int>;
+            uint64_t get_sample_count() const
+            {
+                return m_count.load(std::memory_order_acquire);
+            }
 
-        using GuiSliderFloat = std::shared_ptr<SliderFloat>;
-        using GuiSliderFloatPtr = SliderFloat *;
+            // CPU in percent of one core, RSS in bytes, threads as a count; 0 before the first sample.
+            float get_latest(Series series) const
+            {
+                uint64_t count = m_count.load(std::memory_order_acquire);
+                return count == 0 ? 0.0f : get_sample(series, count, 0);
+            }
 
-        using GuiSliderInt = std::shared_ptr<SliderInt>;
-        using GuiSliderIntPtr = SliderInt *;
+            uint64_t get_peak_rss() const
+            {
+                return m_peak_rss.load(std::memory_order_relaxed);
+            }
 
-        class InputText : public Object
-        {
-        private:
-            std::string m_name;
-            size_t m_max_length = 0;
-            char *m_text = nullptr;
-            ImGuiInputTextFlags m_flags = 0;
+            virtual void update() override
+            {
+                ImGui::PushID(this);
+                if (!is_sampling())
+                {
+                    ImGui::TextDisabled("/proc/self is not readable");
+                    ImGui::PopID();
+                    return;
+                }
+                ImGui::Text("CPU %.1f%%   RSS %.1f MB (peak %.1f MB)   Threads %.0f", get_latest(Series_Cpu),
+                    get_latest(Series_Rss) / (1024.0f * 1024.0f), get_peak_rss() / (1024.0 * 1024.0), get_latest(Series_Threads));
+                plot("CPU", Series_Cpu, 1.0f, "%.1f%%");
+                plot("RSS", Series_Rss, 1.0f / (1024.0f * 1024.0f), "%.1f MB");
+                plot("Threads", Series_Threads, 1.0f, "%.0f");
+                ImGui::PopID();
+            }
 
-        public:
-            InputText(const std::string& name, size_t max_length, const std::string& default_value = "")
-                : m_name(name), m_max_length(max_length), m_text(new char[max_length + 1])
+            virtual void report_memory(MemoryReport& report) const override
             {
-                set_value(default_value);
+                report.add(MemoryReport::bytes_of(m_name) + Series_Count * m_capacity * sizeof(std::atomic<float>));
             }
 
-            virtual void update() override
+            virtual const std::string& get_name() const override
             {
-                ImGui::InputText(m_name.c_str(), m_text, m_max_length);
+                return m_name;
             }
+        };
 
-            InputText& set_name(const std::string& name)
+        using GuiResourceMonitor = Ref<ResourceMonitor>;
+        using GuiResourceMonitorPtr = ResourceMonitor *;
+#endif
+
+        // One frame of input as seen between ImGui::NewFrame() and ImGui::EndFrame(). Frames are
+        // stored as deltas against the previous one: a flags byte, then only the changed fields.
+        struct InputFrame
+        {
+            enum Field : uint8_t
             {
-                m_name = name;
-                return *this;
+                Field_DisplaySize = 1 << 0,
+                Field_MousePos = 1 << 1,
+                Field_MouseButtons = 1 << 2,
+                Field_MouseWheel = 1 << 3,
+                Field_Modifiers = 1 << 4,
+                Field_Keys = 1 << 5,
+                Field_Text = 1 << 6
+            };
+
+            float delta_time = 0.0f;
+            ImVec2 display_size = ImVec2(0, 0);
+            ImVec2 mouse_pos = ImVec2(-FLT_MAX, -FLT_MAX);
+            uint8_t mouse_buttons = 0;
+            ImVec2 mouse_wheel = ImVec2(0, 0);
+            uint8_t modifiers = 0;
+            std::vector<uint16_t> keys;
+            std::vector<uint32_t> text;
+
+            void capture()
+            {
+                ImGuiIO& io = ImGui::GetIO();
+                delta_time = io.DeltaTime;
+                display_size = io.DisplaySize;
+                mouse_pos = io.MousePos;
+                mouse_buttons = 0;
+                for (int button = 0; button < 5; button++)
+                {
+                    if (io.MouseDown[button])
+                        mouse_buttons |= (uint8_t)(1 << button);
+                }
+                mouse_wheel = ImVec2(io.MouseWheelH, io.MouseWheel);
+                modifiers = (uint8_t)((io.KeyCtrl ? 1 : 0) | (io.KeyShift ? 2 : 0) | (io.KeyAlt ? 4 : 0) | (io.KeySuper ? 8 : 0));
+                keys.clear();
+#if IMGUI_VERSION_NUM >= 18700
+                for (int key = ImGuiKey_NamedKey_BEGIN; key < ImGuiKey_GamepadStart; key++)
+                {
+                    if (ImGui::IsKeyDown((ImGuiKey)key))
+                        keys.push_back((uint16_t)key);
+                }
+#else
+                for (int key = 0; key < IM_ARRAYSIZE(io.KeysDown); key++)
+                {
+                    if (io.KeysDown[key])
+                        keys.push_back((uint16_t)key);
+                }
+#endif
+                text.assign(io.InputQueueCharacters.begin(), io.InputQueueCharacters.end());
             }
 
-            InputText& set_value(const std::string& value)
+            // Feeds the difference from previous into the current context; call before NewFrame().
+            void apply(const InputFrame& previous) const
             {
-                size_t max_copy = std::min(value.size(), m_max_length);
-                memcpy(m_text, value.c_str(), max_copy);
-                m_text[max_copy] = '\0';
-                return *this;
+                ImGuiIO& io = ImGui::GetIO();
+                io.DeltaTime = delta_time;
+                io.DisplaySize = display_size;
+#if IMGUI_VERSION_NUM >= 18700
+                if (mouse_pos.x != previous.mouse_pos.x || mouse_pos.y != previous.mouse_pos.y)
+                    io.AddMousePosEvent(mouse_pos.x, mouse_pos.y);
+                for (int button = 0; button < 5; button++)
+                {
+                    if (((mouse_buttons ^ previous.mouse_buttons) >> button) & 1)
+                        io.AddMouseButtonEvent(button, (mouse_buttons >> button) & 1);
+                }
+                if (mouse_wheel.x != 0.0f || mouse_wheel.y != 0.0f)
+                    io.AddMouseWheelEvent(mouse_wheel.x, mouse_wheel.y);
+#if IMGUI_VERSION_NUM >= 18900
+                static const ImGuiKey MODIFIER_KEYS[4] = {ImGuiMod_Ctrl, ImGuiMod_Shift, ImGuiMod_Alt, ImGuiMod_Super};
+#else
+                static const ImGuiKey MODIFIER_KEYS[4] = {ImGuiKey_ModCtrl, ImGuiKey_ModShift, ImGuiKey_ModAlt, ImGuiKey_ModSuper};
+#endif
+                for (int modifier = 0; modifier < 4; modifier++)
+                {
+                    if (((modifiers ^ previous.modifiers) >> modifier) & 1)
+                        io.AddKeyEvent(MODIFIER_KEYS[modifier], (modifiers >> modifier) & 1);
+                }
+                for (uint16_t key : previous.keys)
+                {
+                    if (!std::binary_search(keys.begin(), keys.end(), key))
+                        io.AddKeyEvent((ImGuiKey)key, false);
+                }
+                for (uint16_t key : keys)
+                {
+                    if (!std::binary_search(previous.keys.begin(), previous.keys.end(), key))
+                        io.AddKeyEvent((ImGuiKey)key, true);
+                }
+#else
+                (void)previous;
+                io.MousePos = mouse_pos;
+                for (int button = 0; button < 5; button++)
+                {
+                    io.MouseDown[button] = (mouse_buttons >> button) & 1;
+                }
+                io.MouseWheelH = mouse_wheel.x;
+                io.MouseWheel = mouse_wheel.y;
+                io.KeyCtrl = modifiers & 1;
+                io.KeyShift = modifiers & 2;
+                io.KeyAlt = modifiers & 4;
+                io.KeySuper = modifiers & 8;
+                memset(io.KeysDown, 0, sizeof(io.KeysDown));
+                for (uint16_t key : keys)
+                {
+                    io.KeysDown[key] = true;
+                }
+#endif
+                for (uint32_t character : text)
+                {
+                    io.AddInputCharacter(character);
+                }
             }
 
-            InputText& set_max_length(size_t max_length)
+            template <typename T>
+            static void write_value(std::vector<uint8_t>& out, const T& value)
             {
-                m_max_length = max_length;
-                return *this;
+                const uint8_t *bytes = (const uint8_t *)&value;
+                out.insert(out.end(), bytes, bytes + sizeof(T));
             }
 
-            InputText& set_flags(ImGuiInputTextFlags flags)
+            template <typename T>
+            static bool read_value(const uint8_t *& data, const uint8_t *end, T& value)
             {
-                m_flags = flags;
-                return *this;
+                if ((size_t)(end - data) < sizeof(T))
+                    return false;
+                memcpy(&value, data, sizeof(T));
+                data += sizeof(T);
+                return true;
             }
 
-            ~InputText()
+            template <typename T>
+            static bool read_array(const uint8_t *& data, const uint8_t *end, std::vector<T>& values)
             {
-                delete[] m_text;
+                uint16_t count = 0;
+                if (!read_value(data, end, count) || (size_t)(end - data) < count * sizeof(T))
+                    return false;
+                values.resize(count);
+                memcpy(values.data(), data, count * sizeof(T));
+                data += count * sizeof(T);
+                return true;
             }
 
-            const char *get_ctext() const
+            void write(std::vector<uint8_t>& out, const InputFrame& previous) const
             {
-                return m_text;
+                uint8_t fields = 0;
+                if (display_size.x != previous.display_size.x || display_size.y != previous.display_size.y)
+                    fields |= Field_DisplaySize;
+                if (mouse_pos.x != previous.mouse_pos.x || mouse_pos.y != previous.mouse_pos.y)
+                    fields |= Field_MousePos;
+                if (mouse_buttons != previous.mouse_buttons)
+                    fields |= Field_MouseButtons;
+                if (mouse_wheel.x != 0.0f || mouse_wheel.y != 0.0f)
+                    fields |= Field_MouseWheel;
+                if (modifiers != previous.modifiers)
+                    fields |= Field_Modifiers;
+                if (keys != previous.keys)
+                    fields |= Field_Keys;
+                if (!text.empty())
+                    fields |= Field_Text;
+
+                write_value(out, fields);
+                write_value(out, delta_time);
+                if (fields & Field_DisplaySize)
+                    write_value(out, display_size);
+                if (fields & Field_MousePos)
+                    write_value(out, mouse_pos);
+                if (fields & Field_MouseButtons)
+                    write_value(out, mouse_buttons);
+                if (fields & Field_MouseWheel)
+                    write_value(out, mouse_wheel);
+                if (fields & Field_Modifiers)
+                    write_value(out, modifiers);
+                if (fields & Field_Keys)
+                {
+                    write_value(out, (uint16_t)keys.size());
+                    for (uint16_t key : keys)
+                        write_value(out, key);
+                }
+                if (fields & Field_Text)
+                {
+                    uint16_t count = (uint16_t)std::min<size_t>(text.size(), UINT16_MAX);
+                    write_value(out, count);
+                    for (uint16_t i = 0; i < count; i++)
+                        write_value(out, text[i]);
+                }
             }
 
-            std::string get_text() const
+            // Decodes the next frame on top of *this (holding the previous frame).
+            bool read(const uint8_t *& data, const uint8_t *end)
             {
-                return std::string(m_text, m_max_length);
+                uint8_t fields = 0;
+                if (!read_value(data, end, fields) || !read_value(data, end, delta_time))
+                    return false;
+                mouse_wheel = ImVec2(0, 0);
+                text.clear();
+                return (!(fields & Field_DisplaySize) || read_value(data, end, display_size))
+                    && (!(fields & Field_MousePos) || read_value(data, end, mouse_pos))
+                    && (!(fields & Field_MouseButtons) || read_value(data, end, mouse_buttons))
+                    && (!(fields & Field_MouseWheel) || read_value(data, end, mouse_wheel))
+                    && (!(fields & Field_Modifiers) || read_value(data, end, modifiers))
+                    && (!(fields & Field_Keys) || read_array(data, end, keys))
+                    && (!(fields & Field_Text) || read_array(data, end, text));
             }
         };
 
-        using GuiInputText = std::shared_ptr<InputText>;
-        using GuiInputTextPtr = InputText *;
-
-        class Checkbox : public Object
+        // Captures input once per frame into a compact binary recording. Recordings use the host
+        // byte order and ImGui key codes, so replay them with the same ImGui version they came from.
+        class InputRecorder
         {
         private:
-            std::string m_name;
-            bool m_value = false;
+            std::vector<uint8_t> m_data;
+            InputFrame m_previous;
+            InputFrame m_frame;
+            size_t m_frame_count = 0;
 
         public:
-            Checkbox(const std::string& name, bool value = false)
-                : m_name(name), m_value(value)
-            {
-            }
+            static constexpr uint32_t MAGIC = 0x52494445; // "EDIR"
+            static constexpr uint32_t VERSION = IMGUI_VERSION_NUM;
 
-            virtual void update() override
+            // Call after ImGui::NewFrame() and before ImGui::EndFrame()/Render().
+            InputRecorder& capture()
             {
-                ImGui::Checkbox(m_name.c_str(), &m_value);
+                m_frame.capture();
+                m_frame.write(m_data, m_previous);
+                std::swap(m_previous, m_frame);
+                m_frame_count++;
+                return *this;
             }
 
-            Checkbox& set_name(const std::string& name)
+            InputRecorder& clear()
             {
-                m_name = name;
+                m_data.clear();
+                m_previous = InputFrame();
+                m_frame_count = 0;
                 return *this;
             }
 
-            Checkbox& set_value(bool value)
+            size_t get_frame_count() const
             {
-                m_value = value;
-                return *this;
+                return m_frame_count;
             }
 
-            bool get_value() const
+            bool save(const std::string& path) const
             {
-                return m_value;
+                FILE *file = fopen(path.c_str(), "wb");
+                if (file == nullptr)
+                    return false;
+                uint32_t header[3] = {MAGIC, VERSION, (uint32_t)m_frame_count};
+                bool written = fwrite(header, sizeof(header), 1, file) == 1
+                    && (m_data.empty() || fwrite(m_data.data(), m_data.size(), 1, file) == 1);
+                return fclose(file) == 0 && written;
             }
         };
 
-        using GuiCheckbox = std::shared_ptr<Checkbox>;
-        using GuiCheckboxPtr = Checkbox *;
-
-        class Combo : public Object
+        class InputReplayer
         {
         private:
-            std::string m_name;
-            int m_current_item = 0;
-            std::vector<char *> m_items;
+            std::vector<uint8_t> m_data;
+            size_t m_offset = 0;
+            InputFrame m_previous;
+            size_t m_frame_count = 0;
+            size_t m_frame_index = 0;
 
         public:
-            Combo(const std::string& name, int current_item = 0)
-                : m_name(name), m_current_item(current_item)
+            bool load(const std::string& path)
             {
+                FILE *file = fopen(path.c_str(), "rb");
+                if (file == nullptr)
+                    return false;
+                uint32_t header[3] = {};
+                bool valid = fread(header, sizeof(header), 1, file) == 1
+                    && header[0] == InputRecorder::MAGIC && header[1] == InputRecorder::VERSION;
+                std::vector<uint8_t> data;
+                uint8_t buffer[1 << 16];
+                size_t size;
+                while (valid && (size = fread(buffer, 1, sizeof(buffer), file)) > 0)
+                {
+                    data.insert(data.end(), buffer, buffer + size);
+                }
+                fclose(file);
+                if (!valid)
+                    return false;
+                m_data = std::move(data);
+                m_frame_count = header[2];
+                rewind();
+                return true;
             }
 
-            virtual void update() override
-            {
-                ImGui::Combo(m_name.c_str(), &m_current_item, m_items.data(), m_items.size());
-            }
-
-            Combo& set_name(const std::string& name)
+            void rewind()
             {
-                m_name = name;
-                return *this;
+                m_offset = 0;
+                m_frame_index = 0;
+                m_previous = InputFrame();
             }
 
-            void clear()
+            // Feeds the next recorded frame; call before ImGui::NewFrame(). False once exhausted or on a
+            // truncated recording, which also marks the replayer finished.
+            bool apply()
             {
-                for (auto& item : m_items)
+                if (m_frame_index == m_frame_count)
+                    return false;
+                const uint8_t *data = m_data.data() + m_offset;
+                const uint8_t *end = m_data.data() + m_data.size();
+                InputFrame frame = m_previous;
+                if (!frame.read(data, end))
                 {
-                    delete[] item;
+                    m_frame_index = m_frame_count;
+                    return false;
                 }
-                m_items.clear();
+                frame.apply(m_previous);
+                m_previous = std::move(frame);
+                m_offset = data - m_data.data();
+                m_frame_index++;
+                return true;
             }
 
-            Combo& add_items(const std::vector<std::string>& items)
+            bool is_finished() const
             {
-                clear();
-                for (auto& item : items)
-                {
-                    add_item(item);
-                }
-                m_current_item = 0;
-                return *this;
+                return m_frame_index == m_frame_count;
             }
 
-            Combo& add_item(const std::string& item)
+            size_t get_frame_count() const
             {
-                char* cstr = new char[item.size() + 1];
-                memcpy(cstr, item.c_str(), item.size());
-                cstr[item.size()] = '\0';
-
-                m_items.push_back(cstr);
-                return *this;
+                return m_frame_count;
             }
 
-            Combo& set_current_item_index(int current_item)
+            size_t get_frame_index() const
             {
-                m_current_item = current_item;
-                return *this;
+                return m_frame_index;
             }
+        };
 
-            int get_current_item_index() const
-            {
-                return m_current_item;
-            }
+        // An ImGui context without platform or renderer backend, for benchmarks and replays.
+        // Frames are built and rendered into ImDrawData that nothing consumes.
+        class HeadlessContext
+        {
+        private:
+            ImGuiContext *m_context;
+            ImGuiContext *m_previous;
 
-            const char *get_current_item() const
+        public:
+            HeadlessContext(const ImVec2& display_size = ImVec2(1920, 1080))
+                : m_previous(ImGui::GetCurrentContext())
             {
-                if ((unsigned int)m_current_item >= m_items.size()) {
-                    return nullptr;
-                }
-                return m_items[m_current_item];
+                m_context = ImGui::CreateContext();
+                ImGui::SetCurrentContext(m_context);
+                ImGuiIO& io = ImGui::GetIO();
+                io.DisplaySize = display_size;
+                io.DeltaTime = 1.0f / 60.0f;
+                io.IniFilename = nullptr;
+                unsigned char *pixels = nullptr;
+                int width = 0;
+                int height = 0;
+                io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
             }
 
-            const std::vector<char *>& get_items() const
+            HeadlessContext(const HeadlessContext&) = delete;
+            HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+            ~HeadlessContext()
             {
-                return m_items;
+                ImGui::DestroyContext(m_context);
+                ImGui::SetCurrentContext(m_previous);
             }
 
-            ~Combo()
+            template <typename F>
+            ImDrawData *frame(F&& build)
             {
-                clear();
+                ImGui::SetCurrentContext(m_context);
+                ImGui::NewFrame();
+                build();
+                ImGui::Render();
+                return ImGui::GetDrawData();
             }
         };
-        
-        using GuiCombo = std::shared_ptr<Combo>;
-        using GuiComboPtr = Combo *;
-        
-        class FuzzyCombo : public Object
+
+        // Limits checked by PerfSuite; zero disables a check. Measured values may exceed a limit by
+        // the tolerance fraction before the scenario fails.
+        struct PerfBudget
+        {
+            double frame_ms_p95 = 0.0;
+            double allocations_per_frame = 0.0;
+            size_t memory_bytes = 0;
+            double tolerance = 0.1;
+        };
+
+        struct PerfResult
+        {
+            std::string name;
+            size_t frames = 0;
+            double frame_ms_mean = 0.0;
+            double frame_ms_p50 = 0.0;
+            double frame_ms_p95 = 0.0;
+            double frame_ms_max = 0.0;
+            double allocations_per_frame = -1.0;
+            size_t memory_bytes = 0;
+            bool passed = true;
+            std::string failure;
+        };
+
+        // Runs headless scenarios against budgets and reports machine-readable results. A scenario
+        // factory builds its widgets once and returns the callback run inside every frame.
+        class PerfSuite
         {
+        public:
+            using FrameCallback = std::function<void(size_t)>;
+            using Factory = std::function<FrameCallback()>;
+
         private:
-            std::string m_name;
-            InputText m_input_text;
-            std::vector<std::string> m_items;
-            Combo m_filtered_combo;
-        
+            struct Scenario
+            {
+                std::string name;
+                size_t frames;
+                PerfBudget budget;
+                Factory factory;
+            };
+
+            std::vector<Scenario> m_scenarios;
+            std::vector<PerfResult> m_results;
+            size_t m_warmup_frames = 5;
+
         public:
-            FuzzyCombo(const std::string& name, int current_item = 0)
-                : m_name(name)
-                , m_input_text(name, 256)
-                , m_filtered_combo(name, current_item)
+            // Nearest-rank percentile of already sorted samples.
+            static double percentile(const std::vector<double>& sorted, double fraction)
             {
+                if (sorted.empty())
+                    return 0.0;
+                return sorted[std::min(sorted.size() - 1, (size_t)(fraction * (sorted.size() - 1) + 0.5))];
             }
 
-            InputText& get_input_text()
+            // Fails result when value exceeds limit by more than the tolerance fraction.
+            static void check(PerfResult& result, const char *what, double value, double limit, double tolerance)
             {
-                return m_input_text;
+                if (limit <= 0.0 || value < 0.0 || value <= limit * (1.0 + tolerance))
+                    return;
+                char message[128];
+                snprintf(message, sizeof(message), "%s%s %.3f over budget %.3f", result.failure.empty() ? "" : "; ", what, value, limit);
+                result.failure += message;
+                result.passed = false;
             }
 
-            void set_items(const std::vector<std::string>& items)
+        private:
+            static void write_escaped(FILE *file, const std::string& text)
             {
-                m_items = items;
+                for (unsigned char c : text)
+                {
+                    if (c == '"' || c == '\\')
+                        fprintf(file, "\\%c", c);
+                    else if (c < 0x20)
+                        fprintf(file, "\\u%04x", c);
+                    else
+                        fputc(c, file);
+                }
             }
 
-            virtual void update() override
+            PerfResult run_scenario(const Scenario& scenario) const
             {
-                ImGui::BeginGroup();
-                m_input_text.update();
-
-                std::string input_text = m_input_text.get_text();
-                std::transform(input_text.begin(), input_text.end(), input_text.begin(), ::tolower);
-
-                static const float SCORE_EQUAL = 10;
-                static const float SCORE_NOT_SAME = -15;
+                PerfResult result;
+                result.name = scenario.name;
+                result.frames = scenario.frames;
+
+                HeadlessContext context;
+                size_t memory_before = get_resident_bytes();
+                FrameCallback callback = scenario.factory();
+                for (size_t frame = 0; frame < m_warmup_frames; frame++)
+                {
+                    context.frame([&] { callback(frame); });
+                }
 
-                std::vector<std::pair<std::string, float>> valids;
-
-                for (auto& item : m_items) {
-                    float score = 0;
-                    float max_score = SCORE_EQUAL * std::min(input_text.size(), item.size());
-                    std::string item_str = item;
-
-                    std::transform(item_str.begin(), item_str.end(), item_str.begin(), ::tolower);
-                    // fuzzy search
-                    for (size_t i = 0; i < input_text.size(); i++) {
-                        char c = input_text[i];
-                        auto it = std::find(item_str.begin(), item_str.end(), c);
-                        if (it != item_str.end()) {
-                            score += SCORE_EQUAL;
-                            item_str.erase(it);
-                        } else {
-                            score += SCORE_NOT_SAME;
-                        }
-                    }
-                    float score_percent = score / max_score;
-                    if (score_percent > 0.60f) {
-                        auto it = std::find_if(valids.begin(), valids.end(), [&](const std::pair<std::string, float>& p) {
-                            return p.second < score_percent;
-                        });
-                        if (it != valids.end()) {
-                            valids.insert(it, std::make_pair(item, score_percent));
-                        } else {
-                            valids.push_back(std::make_pair(item, score_percent));
-                        }
-                    }
+                std::vector<double> times;
+                times.reserve(scenario.frames);
+                uint64_t allocations = Metrics::get_allocation_count();
+                for (size_t frame = 0; frame < scenario.frames; frame++)
+                {
+                    uint64_t begin = Trace::now();
+                    context.frame([&] { callback(m_warmup_frames + frame); });
+                    times.push_back((Trace::now() - begin) / 1e6);
                 }
+                if (Metrics::counts_allocations() && scenario.frames > 0)
+                    result.allocations_per_frame = (double)(Metrics::get_allocation_count() - allocations) / scenario.frames;
+                size_t memory_after = get_resident_bytes();
+                result.memory_bytes = memory_after > memory_before ? memory_after - memory_before : 0;
 
-                m_filtered_combo.clear();
-                for (auto& item : valids) {
-                    m_filtered_combo.add_item(item.first);
+                if (!times.empty())
+                {
+                    result.frame_ms_mean = std::accumulate(times.begin(), times.end(), 0.0) / times.size();
+                    std::sort(times.begin(), times.end());
+                    result.frame_ms_p50 = percentile(times, 0.5);
+                    result.frame_ms_p95 = percentile(times, 0.95);
+                    result.frame_ms_max = times.back();
                 }
-                m_filtered_combo.set_current_item_index(0);
-                m_filtered_combo.update();
 
-                ImGui::EndGroup();
+                const PerfBudget& budget = scenario.budget;
+                check(result, "frame_ms_p95", result.frame_ms_p95, budget.frame_ms_p95, budget.tolerance);
+                check(result, "allocations_per_frame", result.allocations_per_frame, budget.allocations_per_frame, budget.tolerance);
+                check(result, "memory_bytes", (double)result.memory_bytes, (double)budget.memory_bytes, budget.tolerance);
+                return result;
             }
 
-            Combo& get_filtered_combo()
+        public:
+            // Resident set size of the process, or 0 where it cannot be read.
+            static size_t get_resident_bytes()
             {
-                return m_filtered_combo;
+#ifdef __linux__
+                FILE *file = fopen("/proc/self/statm", "r");
+                if (file == nullptr)
+                    return 0;
+                unsigned long long pages = 0;
+                unsigned long long resident = 0;
+                int fields = fscanf(file, "%llu %llu", &pages, &resident);
+                fclose(file);
+                return fields == 2 ? (size_t)(resident * (unsigned long long)sysconf(_SC_PAGESIZE)) : 0;
+#else
+                return 0;
+#endif
             }
-        };
 
-        using GuiFuzzyCombo = std::shared_ptr<FuzzyCombo>;
-        using GuiFuzzyComboPtr = FuzzyCombo *;
+            PerfSuite& add_scenario(const std::string& name, size_t frames, const PerfBudget& budget, Factory factory)
+            {
+                m_scenarios.push_back({name, frames, budget, std::move(factory)});
+                return *this;
+            }
 
-        class Child : public Object
-        {
-        private:
-            std::string m_name;
-            std::vector<GuiObject> m_children;
-        
-        public:
-            Child(const std::string& name)
-                : m_name(name)
+            PerfSuite& set_warmup_frames(size_t warmup_frames)
             {
+                m_warmup_frames = warmup_frames;
+                return *this;
             }
 
-            virtual void update() override
+            // The reference workloads: a 1M-line Logger scrolled every frame, typing into a 100k-item
+            // FuzzyCombo, a 10M-point PlotLines and a Window of 5k widgets. Budgets are per machine;
+            // pass the ones measured on the release baseline.
+            // Frame callbacks are std::functions and must be copyable, which Ref<T> is not under
+            // unique ownership, so scenarios share the Ref itself.
+            PerfSuite& add_canonical_scenarios(const PerfBudget& logger, const PerfBudget& fuzzy_combo, const PerfBudget& plot_lines, const PerfBudget& widgets)
             {
-                ImGui::BeginChild(m_name.c_str());
-                for (auto& child : m_children)
+                add_scenario("logger_scroll_1m", 300, logger, [] {
+                    auto logger = std::make_shared<GuiLogger>(make_gui<Logger>(1.0f, 1.0f, 1.0f, 1.0f));
+                    std::string text;
+                    char line[64];
+                    for (size_t i = 0; i < 1000000; i++)
+                    {
+                        text.append(line, snprintf(line, sizeof(line), "[%08zu] \x1b[32minfo\x1b[0m message %zu\n", i, i * 2654435761u));
+                    }
+                    (*logger)->add_text(text);
+                    return FrameCallback([logger](size_t frame) {
+                        ImGui::Begin("logger_scroll_1m");
+                        ImGui::SetScrollY((float)(frame * 997 % 1000000) * ImGui::GetTextLineHeightWithSpacing());
+                        update_object(**logger);
+                        ImGui::End();
+                    });
+                });
+
+                add_scenario("fuzzy_combo_typing_100k", 300, fuzzy_combo, [] {
+                    GuiFuzzyCombo combo = make_gui<FuzzyCombo>("##fuzzy");
+                    FuzzyCombo *combo_ptr = combo.get();
+                    std::vector<std::string> items;
+                    items.reserve(100000);
+                    for (size_t i = 0; i < 100000; i++)
+                    {
+                        items.push_back("item_" + std::to_string(i * 2654435761u % 1000003) + "_entry");
+                    }
+                    combo->set_items(items);
+                    auto window = std::make_shared<GuiWindow>(make_gui<Window>("fuzzy_combo_typing_100k"));
+                    (*window)->add_object(std::move(combo));
+                    return FrameCallback([window, combo_ptr](size_t frame) {
+                        static const std::string query = "item_4242_entry";
+                        combo_ptr->get_input_text().set_value(query.substr(0, (frame / 10) % (query.size() + 1)));
+                        (*window)->update();
+                    });
+                });
+
+                add_scenario("plot_lines_10m", 120, plot_lines, [] {
+                    std::vector<float> values(10000000);
+                    for (size_t i = 0; i < values.size(); i++)
+                    {
+                        values[i] = std::sin(i * 0.001f) + (float)(i % 97) * 0.01f;
+                    }
+                    auto plot = std::make_shared<GuiPlotLines>(make_gui<PlotLines>("##plot", values));
+                    (*plot)->set_graph_size(ImVec2(1600, 300));
+                    return FrameCallback([plot](size_t) {
+                        ImGui::Begin("plot_lines_10m");
+                        update_object(**plot);
+                        ImGui::End();
+                    });
+                });
+
+                add_scenario("window_5k_widgets", 300, widgets, [] {
+                    auto window = std::make_shared<GuiWindow>(make_gui<Window>("window_5k_widgets"));
+                    for (size_t i = 0; i < 5000; i++)
+                    {
+                        std::string name = "widget " + std::to_string(i);
+                        if (i % 2 == 0)
+                            (*window)->add_object(make_gui<Button>(name, [] {}));
+                        else
+                            (*window)->add_object(make_gui<Checkbox>(name, i % 4 == 1));
+                    }
+                    return FrameCallback([window](size_t) {
+                        (*window)->update();
+                    });
+                });
+                return *this;
+            }
+
+            // Returns true when every scenario stays within its budget.
+            bool run()
+            {
+                m_results.clear();
+                bool passed = true;
+                for (const Scenario& scenario : m_scenarios)
                 {
-                    child->update();
+                    m_results.push_back(run_scenario(scenario));
+                    passed = passed && m_results.back().passed;
                 }
-                ImGui::EndChild();
+                return passed;
             }
 
-            Child& set_name(const std::string& name)
+            const std::vector<PerfResult>& get_results() const
             {
-                m_name = name;
-                return *this;
+                return m_results;
             }
 
-            Child& add_child(const GuiObject& child)
+            void write_json(FILE *file) const
             {
-                m_children.push_back(child);
-                return *this;
+                fprintf(file, "{\"imgui_version\":%d,\"results\":[", IMGUI_VERSION_NUM);
+                for (size_t i = 0; i < m_results.size(); i++)
+                {
+                    const PerfResult& result = m_results[i];
+                    fprintf(file, "%s\n{\"name\":\"", i == 0 ? "" : ",");
+                    write_escaped(file, result.name);
+                    fprintf(file, "\",\"frames\":%zu,\"frame_ms_mean\":%.4f,\"frame_ms_p50\":%.4f,\"frame_ms_p95\":%.4f,\"frame_ms_max\":%.4f,",
+                        result.frames, result.frame_ms_mean, result.frame_ms_p50, result.frame_ms_p95, result.frame_ms_max);
+                    if (result.allocations_per_frame >= 0.0)
+                        fprintf(file, "\"allocations_per_frame\":%.2f,", result.allocations_per_frame);
+                    else
+                        fprintf(file, "\"allocations_per_frame\":null,");
+                    fprintf(file, "\"memory_bytes\":%zu,\"passed\":%s,\"failure\":\"", result.memory_bytes, result.passed ? "true" : "false");
+                    write_escaped(file, result.failure);
+                    fprintf(file, "\"}");
+                }
+                fprintf(file, "\n]}\n");
             }
 
-            Child& add_child(GuiObjectPtr child)
+            bool write_json(const std::string& path) const
             {
-                m_children.push_back(GuiObject(child));
-                return *this;
+                FILE *file = fopen(path.c_str(), "w");
+                if (file == nullptr)
+                    return false;
+                write_json(file);
+                return fclose(file) == 0;
             }
         };
-
-        using GuiChild = std::shared_ptr<Child>;
-        using GuiChildPtr = Child *;
     }
 }
+
+#ifdef EASYDEAR_COUNT_ALLOCATIONS
+// Define EASYDEAR_COUNT_ALLOCATIONS in exactly one translation unit to count allocations per frame.
+void *operator new(size_t size)
+{
+    hl::easygui::Metrics::note_allocation();
+    if (void *pointer = malloc(size ? size : 1))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    hl::easygui::Metrics::note_allocation();
+    return malloc(size ? size : 1);
+}
+
+void *operator new[](size_t size, const std::nothrow_t& tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+void operator delete(void *pointer) noexcept
+{
+    free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept
+{
+    free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept
+{
+    free(pointer);
+}
+
+void operator delete[](void *pointer, size_t) noexcept
+{
+    free(pointer);
+}
+
+void operator delete(void *pointer, const std::nothrow_t&) noexcept
+{
+    free(pointer);
+}
+
+void operator delete[](void *pointer, const std::nothrow_t&) noexcept
+{
+    free(pointer);
+}
+
+// Over-aligned types use their own allocation functions, which must pair with the deletes below.
+void *operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    hl::easygui::Metrics::note_allocation();
+    size_t align = (size_t)alignment;
+    size = (std::max<size_t>(size, 1) + align - 1) / align * align;
+#ifdef _WIN32
+    return _aligned_malloc(size, align);
+#else
+    return aligned_alloc(align, size);
+#endif
+}
+
+void *operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t& tag) noexcept
+{
+    return operator new(size, alignment, tag);
+}
+
+void *operator new(size_t size, std::align_val_t alignment)
+{
+    if (void *pointer = operator new(size, alignment, std::nothrow))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+void operator delete(void *pointer, std::align_val_t) noexcept
+{
+#ifdef _WIN32
+    _aligned_free(pointer);
+#else
+    free(pointer);
+#endif
+}
+
+void operator delete[](void *pointer, std::align_val_t alignment) noexcept
+{
+    operator delete(pointer, alignment);
+}
+
+void operator delete(void *pointer, size_t, std::align_val_t alignment) noexcept
+{
+    operator delete(pointer, alignment);
+}
+
+void operator delete[](void *pointer, size_t, std::align_val_t alignment) noexcept
+{
+    operator delete(pointer, alignment);
+}
+
+void operator delete(void *pointer, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    operator delete(pointer, alignment);
+}
+
+void operator delete[](void *pointer, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    operator delete(pointer, alignment);
+}
+#endif
@@ -0,0 +1,345 @@
+// Headless checks for EasyDear's non-visual building blocks. No backend or window is needed:
+//
+//   c++ -std=c++20 -I<imgui> -I.. headless_tests.cpp <imgui>/imgui*.cpp -pthread -o headless_tests
+//
+// Build once more with -fsanitize=thread to check the Scheduler. C++17 builds skip the Task tests.
+
+#include "EasyDear.hpp"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace hl::easygui;
+
+static int g_failures = 0;
+
+#define CHECK(condition)                                                        \
+    do                                                                          \
+    {                                                                           \
+        if (!(condition))                                                       \
+        {                                                                       \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            g_failures++;                                                       \
+        }                                                                       \
+    } while (0)
+
+static bool contains(const std::string& text, const std::string& part)
+{
+    return text.find(part) != std::string::npos;
+}
+
+static void test_height_index()
+{
+    HeightIndex index;
+    std::vector<float> heights;
+    for (size_t i = 0; i < 1000; i++)
+    {
+        heights.push_back((float)(i % 7 + 1));
+        index.push_back(heights.back());
+    }
+    index.set(500, 40.0f);
+    heights[500] = 40.0f;
+
+    double sum = 0.0;
+    for (size_t i = 0; i < heights.size(); i++)
+    {
+        CHECK(index.prefix(i) == sum);
+        CHECK(index.find(sum) == i);
+        CHECK(index.find(sum + heights[i] * 0.5) == i);
+        sum += heights[i];
+    }
+    CHECK(index.total() == sum);
+    CHECK(index.find(sum + 100.0) == heights.size() - 1);
+    CHECK(index.find(-1.0) == 0);
+
+    index.clear();
+    CHECK(index.size() == 0 && index.find(10.0) == 0);
+}
+
+static void test_ansi_parser()
+{
+    AnsiParser parser;
+    std::string out;
+    std::vector<TextSpan> spans;
+    const std::string text = "a\x1b[1;31mbc\x1b[0md\x1b]0;title\x07" "e\x1b[38;2;1;2;3mf";
+    parser.parse(text.data(), text.size(), out, spans);
+
+    CHECK(out == "abcdef");
+    CHECK(spans.size() == 2);
+    if (spans.size() == 2)
+    {
+        CHECK(spans[0].offset == 1 && spans[0].length == 2);
+        CHECK(spans[0].color == IM_COL32(205, 49, 49, 255) && spans[0].style == TextStyle_Bold);
+        CHECK(spans[1].offset == 5 && spans[1].length == 1);
+        CHECK(spans[1].color == IM_COL32(1, 2, 3, 255) && spans[1].style == TextStyle_None);
+    }
+
+    // The SGR state carries over to the next call.
+    spans.clear();
+    parser.parse("g", 1, out, spans);
+    CHECK(spans.size() == 1 && spans[0].offset == 6 && spans[0].color == IM_COL32(1, 2, 3, 255));
+    parser.reset();
+    CHECK(parser.is_default());
+}
+
+static void test_bitset()
+{
+    Bitset bits(130);
+    CHECK(bits.size() == 130 && !bits.any());
+    bits.set_range(3, 70);
+    bits.set(129);
+    CHECK(bits.count() == 68);
+    CHECK(bits.find_next(0) == 3);
+    CHECK(bits.find_next(70) == 129);
+    CHECK(bits.find_next(130) == Bitset::npos);
+
+    bits.flip(3);
+    bits.reset(69);
+    size_t visited = 0;
+    size_t last = 0;
+    bits.for_each_set([&](size_t index) {
+        visited++;
+        last = index;
+    });
+    CHECK(visited == 66 && last == 129);
+
+    bits.set_all();
+    CHECK(bits.count() == 130);
+    bits.resize(200, true);
+    CHECK(bits.count() == 200 && bits.test(199));
+    bits.resize(65);
+    CHECK(bits.count() == 65 && bits.word_count() == 2);
+}
+
+static bool same_frame(const InputFrame& a, const InputFrame& b)
+{
+    return a.delta_time == b.delta_time && a.display_size.x == b.display_size.x && a.display_size.y == b.display_size.y
+        && a.mouse_pos.x == b.mouse_pos.x && a.mouse_pos.y == b.mouse_pos.y && a.mouse_buttons == b.mouse_buttons
+        && a.mouse_wheel.x == b.mouse_wheel.x && a.mouse_wheel.y == b.mouse_wheel.y && a.modifiers == b.modifiers
+        && a.keys == b.keys && a.text == b.text;
+}
+
+static void test_input_frame_round_trip()
+{
+    std::vector<InputFrame> frames(4);
+    frames[0].delta_time = 0.016f;
+    frames[0].display_size = ImVec2(800, 600);
+    frames[0].mouse_pos = ImVec2(10, 20);
+    frames[1] = frames[0];
+    frames[1].mouse_buttons = 1;
+    frames[1].keys = {12, 300};
+    frames[1].text = {'h', 0x1F600};
+    frames[2] = frames[1];
+    frames[2].text.clear();
+    frames[2].mouse_wheel = ImVec2(0, -1);
+    frames[2].modifiers = 3;
+    frames[3] = frames[2];
+    frames[3].mouse_wheel = ImVec2(0, 0);
+    frames[3].keys.clear();
+
+    std::vector<uint8_t> data;
+    InputFrame previous;
+    for (const InputFrame& frame : frames)
+    {
+        frame.write(data, previous);
+        previous = frame;
+    }
+
+    const uint8_t *read = data.data();
+    const uint8_t *end = data.data() + data.size();
+    InputFrame decoded;
+    for (const InputFrame& frame : frames)
+    {
+        CHECK(decoded.read(read, end));
+        CHECK(same_frame(decoded, frame));
+    }
+    CHECK(read == end);
+    CHECK(!decoded.read(read, end));
+
+    // A truncated frame fails instead of reading past the end.
+    read = data.data();
+    end = data.data() + data.size() / 2;
+    bool failed = false;
+    for (size_t i = 0; i < frames.size() && !failed; i++)
+    {
+        failed = !decoded.read(read, end);
+    }
+    CHECK(failed && read <= end);
+}
+
+static void test_perf_suite()
+{
+    std::vector<double> sorted = {1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0, 9.0, 10.0, 11.0};
+    CHECK(PerfSuite::percentile(sorted, 0.0) == 1.0);
+    CHECK(PerfSuite::percentile(sorted, 0.5) == 6.0);
+    CHECK(PerfSuite::percentile(sorted, 0.95) == 11.0);
+    CHECK(PerfSuite::percentile(sorted, 1.0) == 11.0);
+    CHECK(PerfSuite::percentile({}, 0.5) == 0.0);
+
+    PerfResult result;
+    PerfSuite::check(result, "frame_ms_p95", 10.9, 10.0, 0.1);
+    PerfSuite::check(result, "memory_bytes", 50.0, 0.0, 0.1);
+    PerfSuite::check(result, "allocations_per_frame", -1.0, 1.0, 0.1);
+    CHECK(result.passed && result.failure.empty());
+    PerfSuite::check(result, "frame_ms_p95", 11.5, 10.0, 0.1);
+    PerfSuite::check(result, "memory_bytes", 200.0, 100.0, 0.1);
+    CHECK(!result.passed);
+    CHECK(result.failure == "frame_ms_p95 11.500 over budget 10.000; memory_bytes 200.000 over budget 100.000");
+}
+
+static void test_metrics_text()
+{
+    Metrics::note_log_ingest(3, 42);
+    Metrics::observe_fuzzy_search(1000);
+    Metrics::observe_fuzzy_search(2000000000);
+
+    std::string text;
+    Metrics::write_prometheus(text);
+    CHECK(contains(text, "# TYPE easydear_frames_total counter\neasydear_frames_total "));
+    CHECK(contains(text, "\neasydear_logger_lines_total 3\n"));
+    CHECK(contains(text, "\neasydear_logger_bytes_total 42\n"));
+    CHECK(contains(text, "# TYPE easydear_fuzzy_search_seconds histogram\n"));
+    CHECK(contains(text, "\neasydear_fuzzy_search_seconds_bucket{le=\"0.0005\"} 1\n"));
+    CHECK(contains(text, "\neasydear_fuzzy_search_seconds_bucket{le=\"1\"} 1\n"));
+    CHECK(contains(text, "\neasydear_fuzzy_search_seconds_bucket{le=\"+Inf\"} 2\n"));
+    CHECK(contains(text, "\neasydear_fuzzy_search_seconds_count 2\n"));
+    CHECK(text.back() == '\n');
+}
+
+template <typename F>
+static bool run_until(Scheduler& scheduler, F&& done)
+{
+    for (int frame = 0; frame < 5000; frame++)
+    {
+        scheduler.run(0.001);
+        if (done())
+            return true;
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    return false;
+}
+
+static void test_scheduler()
+{
+    Scheduler scheduler;
+    int ui_steps = 0;
+    std::atomic<int> worker_steps{0};
+    std::atomic<int> posted{0};
+
+    JobHandle ui = scheduler.schedule([&] { return ++ui_steps == 50; });
+    JobHandle worker = scheduler.schedule_worker([&] {
+        scheduler.post([&] { posted++; });
+        return ++worker_steps == 100;
+    });
+    CHECK(run_until(scheduler, [&] { return ui.is_finished() && worker.is_finished() && scheduler.is_idle(); }));
+    CHECK(ui_steps == 50 && worker_steps == 100 && posted == 100);
+
+    JobHandle failing = scheduler.schedule_worker([]() -> bool { throw std::runtime_error("worker"); });
+    bool rethrown = false;
+    for (int frame = 0; frame < 5000 && !rethrown; frame++)
+    {
+        try
+        {
+            scheduler.run(0.001);
+        }
+        catch (const std::runtime_error&)
+        {
+            rethrown = true;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    CHECK(rethrown);
+
+    std::atomic<int> cancelled_steps{0};
+    JobHandle endless = scheduler.schedule_worker([&] {
+        cancelled_steps++;
+        return false;
+    });
+    run_until(scheduler, [&] { return cancelled_steps > 0; });
+    scheduler.cancel_all();
+    CHECK(run_until(scheduler, [&] { return scheduler.is_idle(); }));
+    CHECK(!endless.is_pending());
+}
+
+#ifdef EASYDEAR_HAS_COROUTINES
+static Task count_across_threads(std::atomic<int>& count, std::thread::id ui_thread, bool& on_ui)
+{
+    count++;
+    co_await resume_on_worker();
+    count++;
+    co_await next_frame();
+    co_await resume_on_ui();
+    on_ui = std::this_thread::get_id() == ui_thread;
+    count++;
+}
+
+static Task fail_on_worker()
+{
+    co_await resume_on_worker();
+    throw std::runtime_error("task");
+}
+
+static void test_tasks()
+{
+    Scheduler scheduler;
+    std::atomic<int> count{0};
+    bool on_ui = false;
+    JobHandle task = scheduler.spawn(count_across_threads(count, std::this_thread::get_id(), on_ui));
+    CHECK(run_until(scheduler, [&] { return task.is_finished(); }));
+    CHECK(count == 3 && on_ui);
+
+    JobHandle failing = scheduler.spawn(fail_on_worker());
+    bool rethrown = false;
+    for (int frame = 0; frame < 5000 && !rethrown; frame++)
+    {
+        try
+        {
+            scheduler.run(0.001);
+        }
+        catch (const std::runtime_error&)
+        {
+            rethrown = true;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    CHECK(rethrown);
+}
+#endif
+
+static void test_headless_frame()
+{
+    HeadlessContext context;
+    GuiWindow window = make_gui<Window>("headless");
+    window->add_object(make_gui<Button>("button", [] {}));
+    window->add_object(make_gui<Checkbox>("checkbox", true));
+    ImDrawData *data = nullptr;
+    for (int frame = 0; frame < 3; frame++)
+    {
+        data = context.frame([&] { window->update(); });
+    }
+    CHECK(data != nullptr && data->Valid);
+}
+
+int main()
+{
+    test_height_index();
+    test_ansi_parser();
+    test_bitset();
+    test_input_frame_round_trip();
+    test_perf_suite();
+    test_metrics_text();
+    test_scheduler();
+#ifdef EASYDEAR_HAS_COROUTINES
+    test_tasks();
+#endif
+    test_headless_frame();
+
+    if (g_failures != 0)
+    {
+        fprintf(stderr, "%d check(s) failed\n", g_failures);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}